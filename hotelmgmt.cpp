@@ -1,9 +1,9 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
-#include <queue>
-#include <stack>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <vector>
 #include <limits>
 #include <algorithm>
@@ -12,11 +12,31 @@
 #include <ctime>
 #include <climits>
 #include <cctype>
+#include <cstdio>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string_view>
+#include <charconv>
+#include <csignal>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
 
 #ifdef _WIN32
     #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
 #else
     #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
     #include <unistd.h>
 #endif
 
@@ -38,11 +58,86 @@ using namespace std;
 #define BG_GREEN    "\033[42m"
 
 // Room pricing structure
-const int TOTAL_ROOMS = 10;
-const double ROOM_PRICES[TOTAL_ROOMS] = {5000, 5000, 7000, 7000, 10000, 5000, 7000, 10000, 5000, 7000};
+struct RoomTypeInfo {
+    const char* name;
+    double price;
+    const char* rateLabel;
+};
 
-// Cross-platform terminal utilities
-int getTerminalWidth() {
+const int ROOM_TYPE_COUNT = 3;
+const RoomTypeInfo ROOM_TYPES[ROOM_TYPE_COUNT] = {
+    {"Standard", 5000, "Rs 5,000"}, {"Deluxe", 7000, "Rs 7,000"}, {"Suite", 10000, "Rs 10,000"}};
+
+// Room inventory used for hotels without a <hotel>_rooms.txt: room i gets
+// type DEFAULT_LAYOUT[(i - 1) % DEFAULT_LAYOUT_SIZE] (indexes into ROOM_TYPES)
+const int DEFAULT_ROOMS = 10;
+const int DEFAULT_LAYOUT_SIZE = 10;
+const int DEFAULT_LAYOUT[DEFAULT_LAYOUT_SIZE] = {0, 0, 1, 1, 2, 0, 1, 2, 0, 1};
+
+// Index into ROOM_TYPES, or -1
+int findRoomTypeIndex(const string& name) {
+    for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+        if (name == ROOM_TYPES[t].name) return t;
+    }
+    return -1;
+}
+
+// Journal compaction: the snapshot is rewritten once the journal holds at
+// least this many records (or as many records as there are live bookings)
+const int JOURNAL_MIN_COMPACT = 64;
+
+// Checkouts kept in memory per hotel; older ones are appended to
+// <hotel>_checkouts.txt
+const int CHECKOUT_HISTORY_CAPACITY = 100;
+const int CHECKOUT_PAGE_SIZE = 10;
+
+// Booking table rows and search results shown before asking for the next page
+const int BOOKING_PAGE_SIZE = 20;
+const int SEARCH_PAGE_SIZE = 5;
+
+// Journal records are queued in memory and written by each hotel's
+// persistence thread every flushIntervalMs, or sooner once flushBatch records
+// are waiting. In durable mode a change returns only after its record has
+// been fsync'd; changes made meanwhile share that write.
+struct PersistOptions {
+    int flushIntervalMs = 200;
+    int flushBatch = 64;
+    bool durable = false;
+};
+
+// The chain's hotels, one "name[,rooms]" per line; without it the chain is
+// the five built-in hotels. Hotels are read in on first use and the least
+// recently used idle ones written out again once the estimated memory of
+// those in memory passes the budget (--memory-mb).
+const char HOTEL_REGISTRY_FILE[] = "hotels.txt";
+const size_t DEFAULT_MEMORY_BUDGET_MB = 256;
+// Index overhead per booking on top of its pool node: the schedule map node,
+// the two ordered set nodes, and its share of the guest index
+const size_t INDEX_BYTES_PER_BOOKING = 200;
+
+// Warnings and errors that are not part of a screen: shown with the screens
+// on the terminal, but sent to stderr in batch mode so that stdout carries
+// only results
+static ostream* noticeStream = &cout;
+
+ostream& notices() {
+    return *noticeStream;
+}
+
+// Cross-platform terminal utilities. Screens are composed in cout's buffer
+// and, since cin is tied to cout, reach the terminal in one write when the
+// next prompt reads input. The width is cached and only re-read after the
+// terminal reports a resize (SIGWINCH).
+static volatile sig_atomic_t terminalResized = 1;
+static int terminalWidth = 80;
+
+#ifndef _WIN32
+extern "C" void onTerminalResize(int) {
+    terminalResized = 1;
+}
+#endif
+
+int queryTerminalWidth() {
 #ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) {
@@ -63,70 +158,316 @@ int getTerminalWidth() {
 #endif
 }
 
-void clearScreen() {
+int getTerminalWidth() {
+#ifdef _WIN32
+    // No resize signal on Windows; the console query is a cheap local call
+    return queryTerminalWidth();
+#else
+    if (terminalResized) {
+        terminalResized = 0;
+        terminalWidth = queryTerminalWidth();
+    }
+    return terminalWidth;
+#endif
+}
+
+// Sets up the terminal for the menus; call before anything is printed
+void initTerminal() {
+    static char outputBuffer[1 << 16];
+    ios::sync_with_stdio(false);
+    cout.rdbuf()->pubsetbuf(outputBuffer, sizeof(outputBuffer));
 #ifdef _WIN32
-    system("cls");
+    #ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+        #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+    #endif
+    // Colours and clearScreen() are ANSI sequences; Windows 10+ consoles
+    // understand them once asked to
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(out, &mode)) {
+        SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
 #else
-    system("clear");
+    // SA_RESTART keeps a resize from interrupting a pending read on cin
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onTerminalResize;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGWINCH, &action, nullptr);
 #endif
 }
 
+// Erase the screen and scrollback, cursor to the top left
+void clearScreen() {
+    cout << "\033[2J\033[3J\033[H";
+}
+
 void centerText(const string& text) {
     int width = getTerminalWidth();
     int pad = max(0, (width - (int)text.size()) / 2);
-    cout << string(pad, ' ') << text << endl;
+    cout << setw(pad) << "" << text << "\n";
 }
 
-// Date utility class
+// Search key for customer names: case-folded, trimmed, inner runs of
+// whitespace collapsed to one space
+string normalizeName(const string& name) {
+    string key;
+    key.reserve(name.size());
+    bool pendingSpace = false;
+    for (char c : name) {
+        if (isspace((unsigned char)c)) {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += (char)tolower((unsigned char)c);
+    }
+    return key;
+}
+
+// Date utility class. A date is a single day number counted from 1970-01-01,
+// so comparisons and stay lengths are plain integer arithmetic; the civil
+// fields are derived on demand.
 class Date {
+private:
+    static constexpr int32_t INVALID = INT32_MIN;
+    int32_t serial;
+
+    struct Civil {
+        int year, month, day;
+    };
+
+    static constexpr bool isLeapYear(int y) {
+        return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    }
+
+    static constexpr int daysInMonth(int m, int y) {
+        return m == 2 ? (isLeapYear(y) ? 29 : 28) : (m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31;
+    }
+
+    // Proleptic Gregorian conversions (H. Hinnant's days_from_civil and
+    // civil_from_days), using 400-year eras of 146097 days
+    static constexpr int32_t daysFromCivil(int y, int m, int d) {
+        y -= m <= 2;
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = y - era * 400;
+        const int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    static constexpr Civil civilFromDays(int32_t z) {
+        z += 719468;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = z - era * 146097;
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        const int d = doy - (153 * mp + 2) / 5 + 1;
+        const int m = mp < 10 ? mp + 3 : mp - 9;
+        return Civil{yoe + era * 400 + (m <= 2), m, d};
+    }
+
+    constexpr explicit Date(int32_t days) : serial(days) {}
+
 public:
-    int day, month, year;
+    constexpr Date() : serial(INVALID) {}
 
-    Date() : day(0), month(0), year(0) {}
-    Date(int d, int m, int y) : day(d), month(m), year(y) {}
+    // Anything that is not a real calendar day in years 1-9999 gives the
+    // invalid Date(), so 31/02 never turns into 03/03
+    constexpr Date(int d, int m, int y)
+        : serial(y >= 1 && y <= 9999 && m >= 1 && m <= 12 && d >= 1 && d <= daysInMonth(m, y)
+                     ? daysFromCivil(y, m, d) : INVALID) {}
 
-    bool isValid() const {
-        if (year < 2024 || year > 2100) return false;
-        if (month < 1 || month > 12) return false;
-        if (day < 1 || day > 31) return false;
+    constexpr int day() const { return civilFromDays(serial).day; }
+    constexpr int month() const { return civilFromDays(serial).month; }
+    constexpr int year() const { return civilFromDays(serial).year; }
 
-        int daysInMonth[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-        
-        if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0))) {
-            daysInMonth[2] = 29;
-        }
+    // Bookings are taken for 2024-2100
+    constexpr bool isValid() const {
+        return serial >= daysFromCivil(2024, 1, 1) && serial <= daysFromCivil(2100, 12, 31);
+    }
+
+    constexpr bool operator<(const Date& other) const {
+        return serial < other.serial;
+    }
 
-        return day <= daysInMonth[month];
+    constexpr bool operator==(const Date& other) const {
+        return serial == other.serial;
     }
 
-    bool operator<(const Date& other) const {
-        if (year != other.year) return year < other.year;
-        if (month != other.month) return month < other.month;
-        return day < other.day;
+    constexpr bool operator<=(const Date& other) const {
+        return serial <= other.serial;
     }
 
-    bool operator==(const Date& other) const {
-        return day == other.day && month == other.month && year == other.year;
+    constexpr int daysBetween(const Date& other) const {
+        return other.serial - serial;
     }
 
-    bool operator<=(const Date& other) const {
-        return *this < other || *this == other;
+    constexpr Date plusDays(int n) const {
+        return Date(serial + n);
     }
 
-    int daysBetween(const Date& other) const {
-        int days1 = year * 365 + month * 30 + day;
-        int days2 = other.year * 365 + other.month * 30 + other.day;
-        return days2 - days1;
+    static const int TEXT_LENGTH = 10;
+
+    // Writes DD/MM/YYYY into out[0..TEXT_LENGTH)
+    void format(char* out) const {
+        if (serial == INVALID) {
+            memcpy(out, "--/--/----", TEXT_LENGTH);
+            return;
+        }
+        Civil c = civilFromDays(serial);
+        out[0] = '0' + c.day / 10;
+        out[1] = '0' + c.day % 10;
+        out[2] = '/';
+        out[3] = '0' + c.month / 10;
+        out[4] = '0' + c.month % 10;
+        out[5] = '/';
+        out[6] = '0' + c.year / 1000;
+        out[7] = '0' + c.year / 100 % 10;
+        out[8] = '0' + c.year / 10 % 10;
+        out[9] = '0' + c.year % 10;
     }
 
     string toString() const {
-        ostringstream oss;
-        oss << setfill('0') << setw(2) << day << "/" 
-            << setw(2) << month << "/" << year;
-        return oss.str();
+        char buf[TEXT_LENGTH];
+        format(buf);
+        return string(buf, TEXT_LENGTH);
     }
 };
 
+static_assert(sizeof(Date) == 4, "Date is a single day number");
+static_assert(Date(1, 3, 2024).daysBetween(Date(1, 3, 2025)) == 365, "civil conversion");
+static_assert(Date(29, 2, 2025) == Date(), "no 29 February in 2025");
+
+// Parses a whole field as a number; surrounding text is an error
+template <typename T>
+bool parseNumber(string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    from_chars_result res = from_chars(text.data(), end, value);
+    return res.ec == errc() && res.ptr == end;
+}
+
+string_view trimView(string_view text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == string_view::npos) return string_view();
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Parses DD/MM/YYYY; returns the invalid Date() on malformed input
+Date parseDate(string_view text) {
+    text = trimView(text);
+    size_t slash1 = text.find('/');
+    size_t slash2 = slash1 == string_view::npos ? slash1 : text.find('/', slash1 + 1);
+    if (slash2 == string_view::npos) return Date();
+
+    int day, month, year;
+    if (!parseNumber(text.substr(0, slash1), day) ||
+        !parseNumber(text.substr(slash1 + 1, slash2 - slash1 - 1), month) ||
+        !parseNumber(text.substr(slash2 + 1), year)) {
+        return Date();
+    }
+    return Date(day, month, year);
+}
+
+// Splits the next comma-separated field off the front of rest
+string_view nextField(string_view& rest) {
+    size_t comma = rest.find(',');
+    string_view field = rest.substr(0, comma);
+    rest.remove_prefix(comma == string_view::npos ? rest.size() : comma + 1);
+    return field;
+}
+
+// Console input helpers shared by the menus. End of input exits.
+Date readDate(const string& prompt) {
+    string input;
+    Date d;
+    while (true) {
+        cout << CYAN << prompt << RESET;
+        cout.flush();
+        if (!getline(cin, input)) {
+            if (cin.eof()) {
+                cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
+                exit(0);
+            }
+            cin.clear();
+            continue;
+        }
+
+        d = parseDate(input);
+        if (d.isValid()) {
+            return d;
+        }
+        cout << RED << "Invalid date format or invalid date. Please use DD/MM/YYYY format." << RESET << "\n";
+    }
+}
+
+// Called from every desk thread, hence the reentrant localtime variants
+Date getCurrentDate() {
+    time_t now = time(0);
+    tm ltm;
+#ifdef _WIN32
+    localtime_s(&ltm, &now);
+#else
+    localtime_r(&now, &ltm);
+#endif
+    return Date(ltm.tm_mday, 1 + ltm.tm_mon, 1900 + ltm.tm_year);
+}
+
+int readInt(const string& prompt, int minVal = INT_MIN, int maxVal = INT_MAX) {
+    int x;
+    while (true) {
+        cout << CYAN << prompt << RESET;
+        cout.flush();
+        if (cin >> x) {
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (x >= minVal && x <= maxVal) {
+                return x;
+            }
+            cout << RED << "Please enter a value between " << minVal << " and " << maxVal << "." << RESET << "\n";
+        } else {
+            if (cin.eof()) {
+                cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
+                exit(0);
+            }
+            cout << RED << "Invalid input. Please enter a number." << RESET << "\n";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+    }
+}
+
+string readNonEmptyString(const string& prompt) {
+    string input;
+    while (true) {
+        cout << CYAN << prompt << RESET;
+        cout.flush();
+        if (!getline(cin, input)) {
+            if (cin.eof()) {
+                cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
+                exit(0);
+            }
+            cin.clear();
+            continue;
+        }
+
+        size_t start = input.find_first_not_of(" \t");
+        size_t end = input.find_last_not_of(" \t");
+
+        if (start != string::npos && end != string::npos) {
+            input = input.substr(start, end - start + 1);
+            if (!input.empty()) {
+                return input;
+            }
+        }
+        cout << RED << "Input cannot be empty. Please try again." << RESET << "\n";
+    }
+}
+
 class Booking {
 public:
     int roomNo;
@@ -137,387 +478,2280 @@ public:
     int numDays;
     string roomType;
     Booking* next;
+    Booking* prev;
+    Booking* guestNext;   // other bookings under the same guest name
+    Booking* guestPrev;
+    int waitTier;         // WaitingList filing, waitSeq -1 when not waiting
+    long long waitSeq;
 
     Booking() {
         roomNo = 0;
         totalAmount = 0;
         numDays = 0;
         next = nullptr;
+        prev = nullptr;
+        guestNext = nullptr;
+        guestPrev = nullptr;
+        waitTier = 0;
+        waitSeq = -1;
+    }
+
+    // A copy that is not linked into any list, for handing out to readers
+    static Booking detached(const Booking* b) {
+        Booking copy;
+        copy.roomNo = b->roomNo;
+        copy.name = b->name;
+        copy.checkInDate = b->checkInDate;
+        copy.checkOutDate = b->checkOutDate;
+        copy.totalAmount = b->totalAmount;
+        copy.numDays = b->numDays;
+        copy.roomType = b->roomType;
+        return copy;
     }
 };
 
-class HotelSystem {
+// One booking as a line of the bookings CSV (without the newline)
+void writeBookingFields(ostream& out, const Booking* b) {
+    out << b->name << ","
+        << b->roomNo << ","
+        << b->roomType << ","
+        << b->checkInDate.toString() << ","
+        << b->checkOutDate.toString() << ","
+        << b->numDays << ","
+        << b->totalAmount;
+}
+
+// Prefix trie over normalized customer names. Each key is reference counted
+// so a name shared by several bookings stays searchable until the last one
+// is removed; its nodes are then pruned and reused by later inserts.
+class NameTrie {
 private:
-    string hotelName;
-    int totalRooms;
-    int bookedRooms;
-    Booking* head;
-    stack<Booking> recentCheckouts;
-    queue<Booking> waitingList;
-    unordered_map<int, Booking*> roomBookingMap;
-    unordered_map<string, Booking*> nameBookingMap;
-    bool roomOccupied[TOTAL_ROOMS + 1];
+    struct Node {
+        map<char, int> children;
+        int terminalCount;
+        int subtreeCount;
+        Node() : terminalCount(0), subtreeCount(0) {}
+    };
 
-    void printLine(string color = CYAN) {
-        cout << color << "----------------------------------------------------------------" << RESET << "\n";
+    vector<Node> nodes;
+    vector<int> freeNodes;   // pruned slots of nodes
+
+    int newNode() {
+        if (freeNodes.empty()) {
+            nodes.push_back(Node());
+            return nodes.size() - 1;
+        }
+        int idx = freeNodes.back();
+        freeNodes.pop_back();
+        return idx;
     }
 
-    bool isRoomAvailable(int roomNo) {
-        return roomNo >= 1 && roomNo <= TOTAL_ROOMS && !roomOccupied[roomNo];
+    void collect(int idx, string& prefix, vector<string>& out, size_t limit) const {
+        if (out.size() >= limit) return;
+        if (nodes[idx].terminalCount > 0) {
+            out.push_back(prefix);
+        }
+        for (auto& child : nodes[idx].children) {
+            prefix.push_back(child.first);
+            collect(child.second, prefix, out, limit);
+            prefix.pop_back();
+            if (out.size() >= limit) return;
+        }
     }
 
-    int findAvailableRoom() {
-        for (int i = 1; i <= TOTAL_ROOMS; i++) {
-            if (!roomOccupied[i]) {
-                return i;
+public:
+    NameTrie() : nodes(1) {}
+
+    void insert(const string& key) {
+        int idx = 0;
+        nodes[idx].subtreeCount++;
+        for (char c : key) {
+            auto it = nodes[idx].children.find(c);
+            if (it == nodes[idx].children.end()) {
+                int child = newNode();
+                it = nodes[idx].children.insert(make_pair(c, child)).first;
             }
+            idx = it->second;
+            nodes[idx].subtreeCount++;
         }
-        return -1;
+        nodes[idx].terminalCount++;
+    }
+
+    // Every other child of an emptied node was pruned when it emptied, so
+    // only the emptied part of the key's own path is left to free
+    void erase(const string& key) {
+        vector<int> path(1, 0);
+        for (char c : key) {
+            auto it = nodes[path.back()].children.find(c);
+            if (it == nodes[path.back()].children.end()) return;
+            path.push_back(it->second);
+        }
+        if (nodes[path.back()].terminalCount == 0) return;
+
+        nodes[path.back()].terminalCount--;
+        for (int idx : path) {
+            nodes[idx].subtreeCount--;
+        }
+
+        for (size_t depth = 1; depth < path.size(); depth++) {
+            if (nodes[path[depth]].subtreeCount > 0) continue;
+            nodes[path[depth - 1]].children.erase(key[depth - 1]);
+            for (size_t d = depth; d < path.size(); d++) {
+                nodes[path[d]].children.clear();
+                freeNodes.push_back(path[d]);
+            }
+            break;
+        }
+    }
+
+    // Rough bytes held, counting each child link as a map node
+    size_t memoryEstimate() const {
+        size_t links = nodes.size() - freeNodes.size() - 1;
+        return nodes.capacity() * sizeof(Node) + freeNodes.capacity() * sizeof(int) +
+               links * (sizeof(pair<const char, int>) + 4 * sizeof(void*));
+    }
+
+    // Keys starting with prefix, in lexicographic order, at most limit
+    vector<string> withPrefix(const string& prefix, size_t limit) const {
+        vector<string> out;
+        int idx = 0;
+        for (char c : prefix) {
+            auto it = nodes[idx].children.find(c);
+            if (it == nodes[idx].children.end()) return out;
+            idx = it->second;
+        }
+        string key = prefix;
+        collect(idx, key, out, limit);
+        return out;
+    }
+};
+
+// Waiting guests of one room type, filed by loyalty tier and then by
+// check-in date; guests with the same tier and check-in are kept longest
+// stay first, then in the order they asked. A gap that opens in a room is
+// matched by looking only at the check-in dates inside it: per tier, from
+// the highest down, the first date with a stay short enough to fit.
+class WaitingList {
+public:
+    static const int TIERS = 4;   // loyaltyTierOf() is 0 to 3
+
+private:
+    // (numDays, waitSeq) of a guest, or of a probe for lower_bound
+    struct StayKey {
+        int numDays;
+        long long seq;
+    };
+
+    struct StayOrder {
+        typedef void is_transparent;
+
+        static StayKey key(const Booking* b) { return StayKey{b->numDays, b->waitSeq}; }
+        static StayKey key(const StayKey& k) { return k; }
+
+        template <class A, class B>
+        bool operator()(const A& a, const B& b) const {
+            StayKey x = key(a), y = key(b);
+            if (x.numDays != y.numDays) return x.numDays > y.numDays;
+            return x.seq < y.seq;
+        }
+    };
+
+    typedef set<Booking*, StayOrder> SameCheckIn;
+
+    map<Date, SameCheckIn> byCheckIn[TIERS];
+    size_t count;
+
+public:
+    WaitingList() : count(0) {}
+
+    bool empty() const { return count == 0; }
+
+    void push(Booking* guest, int loyaltyTier, long long seq) {
+        guest->waitTier = loyaltyTier;
+        guest->waitSeq = seq;
+        byCheckIn[loyaltyTier][guest->checkInDate].insert(guest);
+        count++;
+    }
+
+    void remove(Booking* guest) {
+        auto day = byCheckIn[guest->waitTier].find(guest->checkInDate);
+        day->second.erase(guest);
+        if (day->second.empty()) byCheckIn[guest->waitTier].erase(day);
+        guest->waitSeq = -1;
+        count--;
+    }
+
+    void setLoyaltyTier(Booking* guest, int loyaltyTier) {
+        long long seq = guest->waitSeq;
+        remove(guest);
+        push(guest, loyaltyTier, seq);
+    }
+
+    // Removes and returns the highest-priority guest whose stay lies within
+    // [from, to), or nullptr. to == nullptr leaves the gap open-ended.
+    Booking* takeBest(const Date& from, const Date* to) {
+        for (int tier = TIERS - 1; tier >= 0; tier--) {
+            const map<Date, SameCheckIn>& days = byCheckIn[tier];
+            for (auto day = days.lower_bound(from); day != days.end() && (!to || day->first < *to); ++day) {
+                auto fit = to ? day->second.lower_bound(StayKey{day->first.daysBetween(*to), LLONG_MIN})
+                              : day->second.begin();
+                if (fit != day->second.end()) {
+                    Booking* found = *fit;
+                    remove(found);
+                    return found;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    // Guests from best to worst
+    vector<Booking*> ordered() const {
+        vector<Booking*> sorted;
+        sorted.reserve(count);
+        for (int tier = TIERS - 1; tier >= 0; tier--) {
+            for (auto& day : byCheckIn[tier]) {
+                sorted.insert(sorted.end(), day.second.begin(), day.second.end());
+            }
+        }
+        return sorted;
+    }
+};
+
+// Fixed-capacity ring of the most recent checkouts. Pushing into a full ring
+// hands back the oldest entry so the caller can archive it.
+class CheckoutHistory {
+private:
+    Booking* slots[CHECKOUT_HISTORY_CAPACITY];
+    int start;   // oldest entry
+    int count;
+
+public:
+    CheckoutHistory() : start(0), count(0) {}
+
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+
+    // Returns the evicted oldest entry, or nullptr while there is room
+    Booking* push(Booking* b) {
+        if (count < CHECKOUT_HISTORY_CAPACITY) {
+            slots[(start + count) % CHECKOUT_HISTORY_CAPACITY] = b;
+            count++;
+            return nullptr;
+        }
+        Booking* evicted = slots[start];
+        slots[start] = b;
+        start = (start + 1) % CHECKOUT_HISTORY_CAPACITY;
+        return evicted;
+    }
+
+    // Removes and returns the oldest entry, or nullptr when empty
+    Booking* popOldest() {
+        if (count == 0) return nullptr;
+        Booking* oldest = slots[start];
+        start = (start + 1) % CHECKOUT_HISTORY_CAPACITY;
+        count--;
+        return oldest;
+    }
+
+    // i = 0 is the most recent checkout
+    const Booking* recent(int i) const {
+        return slots[(start + count - 1 - i) % CHECKOUT_HISTORY_CAPACITY];
+    }
+};
+
+// Bit tricks for RoomBitset. GCC and Clang lower these to single POPCNT/TZCNT
+// instructions when built with -mpopcnt -mbmi (or -march=native).
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+// Index of the lowest set bit; x must not be 0
+inline int ctz64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    for (; !(x & 1); x >>= 1) n++;
+    return n;
+#endif
+}
+
+// Bitset over slots 0..n-1 in 64-bit words. A summary word per 64 words marks
+// the non-empty ones, so first() is two ctz64() calls for up to 4096 slots.
+class RoomBitset {
+private:
+    vector<uint64_t> words;
+    vector<uint64_t> summary;
+
+public:
+    void resize(int slots) {
+        words.assign((slots + 63) / 64, 0);
+        summary.assign((words.size() + 63) / 64, 0);
+    }
+
+    // Sets slots 0..slots-1
+    void fill(int slots) {
+        resize(slots);
+        for (int i = 0; i < slots; i += 64) {
+            words[i >> 6] = slots - i >= 64 ? ~0ULL : (1ULL << (slots - i)) - 1;
+            summary[i >> 12] |= 1ULL << ((i >> 6) & 63);
+        }
+    }
+
+    // Clears every slot set in other, a bitset of the same size
+    void subtract(const RoomBitset& other) {
+        for (size_t s = 0; s < summary.size(); s++) {
+            for (uint64_t bits = summary[s] & other.summary[s]; bits; bits &= bits - 1) {
+                size_t w = s * 64 + ctz64(bits);
+                words[w] &= ~other.words[w];
+                if (!words[w]) summary[s] &= ~(1ULL << (w & 63));
+            }
+        }
+    }
+
+    bool none() const {
+        for (uint64_t s : summary) {
+            if (s) return false;
+        }
+        return true;
+    }
+
+    size_t memoryEstimate() const {
+        return (words.capacity() + summary.capacity()) * sizeof(uint64_t);
+    }
+
+    // The words as stored by save(), for a bitset of the given size
+    static size_t savedSize(int slots) {
+        return (slots + 63) / 64 * sizeof(uint64_t);
     }
 
-    int findAvailableRoomByPrice(double price) {
-        for (int i = 1; i <= TOTAL_ROOMS; i++) {
-            if (!roomOccupied[i] && ROOM_PRICES[i - 1] == price) {
-                return i;
+    void save(string& out) const {
+        out.append((const char*)words.data(), words.size() * sizeof(uint64_t));
+    }
+
+    void load(const char* in, int slots) {
+        resize(slots);
+        memcpy(words.data(), in, words.size() * sizeof(uint64_t));
+        for (size_t w = 0; w < words.size(); w++) {
+            if (words[w]) summary[w >> 6] |= 1ULL << (w & 63);
+        }
+    }
+
+    void set(int i) {
+        words[i >> 6] |= 1ULL << (i & 63);
+        summary[i >> 12] |= 1ULL << ((i >> 6) & 63);
+    }
+
+    void reset(int i) {
+        words[i >> 6] &= ~(1ULL << (i & 63));
+        if (!words[i >> 6]) summary[i >> 12] &= ~(1ULL << ((i >> 6) & 63));
+    }
+
+    bool test(int i) const {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // Lowest set slot, or -1 when none is set
+    int first() const {
+        for (size_t s = 0; s < summary.size(); s++) {
+            if (summary[s]) {
+                size_t w = s * 64 + ctz64(summary[s]);
+                return w * 64 + ctz64(words[w]);
             }
         }
         return -1;
     }
 
-    void insertBookingNode(Booking* newBooking) {
-        if (!head) {
-            head = newBooking;
-            return;
+    int count() const {
+        int n = 0;
+        for (uint64_t w : words) n += popcount64(w);
+        return n;
+    }
+
+    // Calls f(slot) for every set slot in ascending order
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words.size(); w++) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                f(int(w * 64 + ctz64(bits)));
+            }
         }
-        Booking* temp = head;
-        while (temp->next) {
-            temp = temp->next;
+    }
+};
+
+// Free capacity of a hotel by room type and night: the rooms with no
+// bookings at all, and for every night somebody has booked, the rooms taken
+// that night. A stay is free in the rooms clear on each booked night it
+// covers, so finding one costs O(booked nights of the stay x rooms / 64)
+// however full the hotel is. Rooms are addressed by their slot in the
+// type's ascending list of room numbers.
+class RoomAvailability {
+private:
+    static constexpr Date NIGHT_ORIGIN = Date(1, 1, 1);
+
+    vector<int> rooms[ROOM_TYPE_COUNT];
+    vector<int> stays[ROOM_TYPE_COUNT];             // bookings per slot
+    RoomBitset idle[ROOM_TYPE_COUNT];
+    map<Date, RoomBitset> taken[ROOM_TYPE_COUNT];   // booked nights only
+
+public:
+    void reset(const vector<int> roomsByType[ROOM_TYPE_COUNT]) {
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            rooms[t] = roomsByType[t];
+            stays[t].assign(rooms[t].size(), 0);
+            idle[t].fill(rooms[t].size());
+            taken[t].clear();
         }
-        temp->next = newBooking;
     }
 
-    void removeBookingNode(int roomNo) {
-        Booking* temp = head;
-        Booking* prev = nullptr;
+    void add(int type, int slot, const Date& checkIn, const Date& checkOut) {
+        if (stays[type][slot]++ == 0) idle[type].reset(slot);
+        map<Date, RoomBitset>& nights = taken[type];
+        auto it = nights.lower_bound(checkIn);
+        for (Date night = checkIn; night < checkOut; night = night.plusDays(1)) {
+            if (it == nights.end() || !(it->first == night)) {
+                it = nights.emplace_hint(it, night, RoomBitset());
+                it->second.resize(rooms[type].size());
+            }
+            it->second.set(slot);
+            ++it;
+        }
+    }
+
+    void remove(int type, int slot, const Date& checkIn, const Date& checkOut) {
+        if (--stays[type][slot] == 0) idle[type].set(slot);
+        map<Date, RoomBitset>& nights = taken[type];
+        auto it = nights.lower_bound(checkIn);
+        while (it != nights.end() && it->first < checkOut) {
+            it->second.reset(slot);
+            it = it->second.none() ? nights.erase(it) : std::next(it);
+        }
+    }
+
+    int idleRooms(int type) const {
+        return idle[type].count();
+    }
+
+    // A room of the type free for [checkIn, checkOut), or -1: the lowest
+    // numbered idle room if there is one, otherwise the lowest free room
+    int findRoom(int type, const Date& checkIn, const Date& checkOut) const {
+        int slot = idle[type].first();
+        if (slot != -1) return rooms[type][slot];
+
+        const map<Date, RoomBitset>& nights = taken[type];
+        RoomBitset free;
+        free.fill(rooms[type].size());
+        for (auto it = nights.lower_bound(checkIn); it != nights.end() && it->first < checkOut; ++it) {
+            free.subtract(it->second);
+            if (free.none()) return -1;
+        }
+        slot = free.first();
+        return slot == -1 ? -1 : rooms[type][slot];
+    }
+
+    // Saved layout, per room type (host byte order, int32 unless noted):
+    //   room count n | room numbers[n] | stays[n] | night count |
+    //   per night: days since 01/01/0001 | taken words (uint64)[(n + 63) / 64]
+    void save(string& out) const {
+        auto put = [&out](int32_t value) { out.append((const char*)&value, sizeof(value)); };
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            put((int32_t)rooms[t].size());
+            for (int room : rooms[t]) put(room);
+            for (int count : stays[t]) put(count);
+            put((int32_t)taken[t].size());
+            for (auto& night : taken[t]) {
+                put(NIGHT_ORIGIN.daysBetween(night.first));
+                night.second.save(out);
+            }
+        }
+    }
+
+    // Returns false if the bytes are not a whole saved layout
+    bool load(const char* in, size_t size) {
+        const char* end = in + size;
+        auto get = [&in, end](int32_t& value) {
+            if (end - in < (ptrdiff_t)sizeof(value)) return false;
+            memcpy(&value, in, sizeof(value));
+            in += sizeof(value);
+            return true;
+        };
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            int32_t count, nights;
+            if (!get(count) || count < 0) return false;
+            rooms[t].assign(count, 0);
+            stays[t].assign(count, 0);
+            idle[t].resize(count);
+            taken[t].clear();
+            for (int32_t& room : rooms[t]) {
+                if (!get(room)) return false;
+            }
+            for (int slot = 0; slot < count; slot++) {
+                if (!get(stays[t][slot])) return false;
+                if (stays[t][slot] == 0) idle[t].set(slot);
+            }
+            if (!get(nights) || nights < 0) return false;
+            size_t words = RoomBitset::savedSize(count);
+            for (int32_t n = 0; n < nights; n++) {
+                int32_t days;
+                if (!get(days) || (size_t)(end - in) < words) return false;
+                auto it = taken[t].emplace_hint(taken[t].end(), NIGHT_ORIGIN.plusDays(days), RoomBitset());
+                it->second.load(in, count);
+                in += words;
+            }
+        }
+        return in == end;
+    }
+
+    size_t memoryEstimate() const {
+        size_t bytes = 0;
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            bytes += (rooms[t].capacity() + stays[t].capacity()) * sizeof(int) + idle[t].memoryEstimate();
+            for (auto& night : taken[t]) {
+                bytes += sizeof(night) + 4 * sizeof(void*) + night.second.memoryEstimate();
+            }
+        }
+        return bytes;
+    }
+};
+
+// Slab allocator for Booking nodes. Nodes are carved out of fixed-size slabs
+// and released nodes go on a free list to be reused by the next booking.
+// A hit is an allocation served from the free list, a miss takes a fresh
+// slot from a slab.
+class BookingPool {
+private:
+    static const int SLAB_SIZE = 256;
+
+    union Slot {
+        Slot* nextFree;
+        alignas(Booking) unsigned char storage[sizeof(Booking)];
+    };
+
+    vector<Slot*> slabs;
+    Slot* freeList;
+    int slabUsed;
+    long long hits;
+    long long misses;
+
+public:
+    BookingPool() : freeList(nullptr), slabUsed(SLAB_SIZE), hits(0), misses(0) {}
+    BookingPool(const BookingPool&) = delete;
+    BookingPool& operator=(const BookingPool&) = delete;
+
+    // Every acquired node must be released before the pool is destroyed
+    ~BookingPool() {
+        for (Slot* slab : slabs) {
+            delete[] slab;
+        }
+    }
+
+    Booking* acquire() {
+        Slot* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = freeList->nextFree;
+            hits++;
+        } else {
+            if (slabUsed == SLAB_SIZE) {
+                slabs.push_back(new Slot[SLAB_SIZE]);
+                slabUsed = 0;
+            }
+            slot = &slabs.back()[slabUsed++];
+            misses++;
+        }
+        return new (slot->storage) Booking();
+    }
+
+    void release(Booking* b) {
+        b->~Booking();
+        Slot* slot = reinterpret_cast<Slot*>(b);
+        slot->nextFree = freeList;
+        freeList = slot;
+    }
+
+    long long getHits() const { return hits; }
+    long long getMisses() const { return misses; }
+    size_t getCapacity() const { return slabs.size() * SLAB_SIZE; }
+};
+
+// Binary snapshot layout (host byte order):
+//   SnapshotHeader | SnapshotRecord[recordCount] | string table | availability
+// Names and room types are stored once each in the string table and records
+// refer to them by offset, so the file can be used in place from a mapping.
+// The availability section is RoomAvailability::save() of the same bookings,
+// so the chain can search a hotel that is not loaded; version 1 files have
+// none.
+const char SNAPSHOT_MAGIC[8] = {'H', 'O', 'T', 'E', 'L', 'S', 'N', 'P'};
+const uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordCount;
+    int64_t journalSeq;
+    uint32_t stringTableSize;
+    uint32_t availabilitySize;
+};
+
+struct SnapshotDate {
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+};
+
+struct SnapshotRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t typeOffset;
+    uint32_t typeLength;
+    int32_t roomNo;
+    int32_t numDays;
+    SnapshotDate checkIn;
+    SnapshotDate checkOut;
+    double totalAmount;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header layout changed");
+static_assert(sizeof(SnapshotRecord) == 40, "snapshot record layout changed");
+
+// Read-only view of a whole file: mmap'd on POSIX, read into memory elsewhere
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+
+public:
+    MappedFile() : bytes(nullptr), length(0) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (bytes) munmap((void*)bytes, length);
+#endif
+    }
+
+    bool open(const string& path) {
+#ifdef _WIN32
+        ifstream fin(path, ios::binary);
+        if (!fin) return false;
+        buffer.assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+        bytes = buffer.data();
+        length = buffer.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) return false;
+
+        bytes = (const char*)mapped;
+        length = st.st_size;
+        return true;
+#endif
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Append-only file that can be forced to disk, for the journal
+class JournalFile {
+private:
+    FILE* file;
+
+public:
+    JournalFile() : file(nullptr) {}
+    JournalFile(const JournalFile&) = delete;
+    JournalFile& operator=(const JournalFile&) = delete;
+
+    ~JournalFile() {
+        if (file) fclose(file);
+    }
+
+    // Opens for appending on first use. With sync the data is also forced
+    // to disk. On failure whatever part of data got in is cut off again, so
+    // writing the same data later does not leave a torn record behind.
+    bool append(const string& path, const string& data, bool sync) {
+        if (!file) file = fopen(path.c_str(), "ab");
+        if (!file || fseek(file, 0, SEEK_END) != 0) return false;
+        long start = ftell(file);
+        if (start < 0) return false;
+
+        bool written = fwrite(data.data(), 1, data.size(), file) == data.size() && fflush(file) == 0;
+#ifdef _WIN32
+        if (written && sync) written = _commit(_fileno(file)) == 0;
+#else
+        if (written && sync) written = fsync(fileno(file)) == 0;
+#endif
+        if (written) return true;
+
+        fclose(file);
+        file = nullptr;
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY);
+        if (fd >= 0) {
+            _chsize(fd, start);
+            _close(fd);
+        }
+#else
+        // If even this fails, replay reports the torn record as a bad line
+        int cut = ::truncate(path.c_str(), start);
+        (void)cut;
+#endif
+        return false;
+    }
+
+    void truncate(const string& path) {
+        if (file) fclose(file);
+        file = fopen(path.c_str(), "wb");
+    }
+};
+
+// Forces a finished file (e.g. a snapshot before it is renamed) to disk
+bool syncFile(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb+");
+    if (!file) return false;
+#ifdef _WIN32
+    bool synced = _commit(_fileno(file)) == 0;
+#else
+    bool synced = fsync(fileno(file)) == 0;
+#endif
+    fclose(file);
+    return synced;
+}
+
+// Forces a rename inside the directory holding path to disk. Windows
+// commits renames with the file system metadata, so there it is a no-op.
+bool syncDirectoryOf(const string& path) {
+#ifdef _WIN32
+    (void)path;
+    return true;
+#else
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+// Orderings for the sorted booking indexes. Ties are broken down to the
+// room so that every live booking has a distinct key.
+struct BookingNameOrder {
+    bool operator()(const Booking* a, const Booking* b) const {
+        if (a->name != b->name) return a->name < b->name;
+        if (!(a->checkInDate == b->checkInDate)) return a->checkInDate < b->checkInDate;
+        return a->roomNo < b->roomNo;
+    }
+};
+
+struct BookingCheckInOrder {
+    bool operator()(const Booking* a, const Booking* b) const {
+        if (!(a->checkInDate == b->checkInDate)) return a->checkInDate < b->checkInDate;
+        return a->roomNo < b->roomNo;
+    }
+};
+
+// Screen output for the booking tables. Text and padded cells are appended to
+// one buffer that keeps its capacity between screens, and flush() hands a
+// whole page to cout in a single write.
+class TableWriter {
+private:
+    string buf;
+
+public:
+    TableWriter() {
+        buf.reserve(1 << 16);
+    }
+
+    TableWriter& operator<<(string_view text) {
+        buf.append(text.data(), text.size());
+        return *this;
+    }
+
+    TableWriter& operator<<(long long n) {
+        char tmp[24];
+        to_chars_result res = to_chars(tmp, tmp + sizeof(tmp), n);
+        buf.append(tmp, res.ptr - tmp);
+        return *this;
+    }
+
+    TableWriter& operator<<(int n) {
+        return *this << (long long)n;
+    }
+
+    TableWriter& operator<<(const Date& d) {
+        char tmp[Date::TEXT_LENGTH];
+        d.format(tmp);
+        buf.append(tmp, sizeof(tmp));
+        return *this;
+    }
+
+    // Left-aligned and padded to width, like setw() with left
+    TableWriter& cell(string_view text, int width) {
+        *this << text;
+        if ((int)text.size() < width) buf.append(width - text.size(), ' ');
+        return *this;
+    }
+
+    TableWriter& cell(long long n, int width) {
+        char tmp[24];
+        to_chars_result res = to_chars(tmp, tmp + sizeof(tmp), n);
+        return cell(string_view(tmp, res.ptr - tmp), width);
+    }
+
+    TableWriter& cell(const Date& d, int width) {
+        *this << d;
+        if (Date::TEXT_LENGTH < width) buf.append(width - Date::TEXT_LENGTH, ' ');
+        return *this;
+    }
+
+    // "Rs" and the amount with two decimals
+    TableWriter& money(double amount) {
+        char tmp[48];
+        to_chars_result res = to_chars(tmp, tmp + sizeof(tmp), amount, chars_format::fixed, 2);
+        return *this << "Rs" << string_view(tmp, res.ptr - tmp);
+    }
+
+    // Moves the page into cout's buffer; it reaches the terminal with the
+    // rest of the screen at the next prompt
+    void flush() {
+        cout.write(buf.data(), buf.size());
+        buf.clear();
+    }
+};
+
+// Each desk thread composes its screens in its own buffer
+thread_local TableWriter screen;
+
+class HotelSystem {
+private:
+    string hotelName;
+    int totalRooms;
+    int maxRoomNo;
+    int legacyRoomsFrom;   // first room kept only for old files, 0 if none
+    // Room inventory, see loadRoomInventory(). availability and freeRooms
+    // work on the slots of roomsByType (roomSlot maps a room number to its
+    // slot). freeRooms holds the rooms with no stay covering the night
+    // freeNight is and is rebuilt when the date moves on.
+    vector<int> roomTypeOf;                     // by room number, -1 if no such room
+    vector<int> roomsByType[ROOM_TYPE_COUNT];   // ascending room numbers
+    vector<int> roomSlot;
+    RoomAvailability availability;
+    mutable RoomBitset freeRooms[ROOM_TYPE_COUNT];
+    mutable Date freeNight;
+    // Stored bookings loadBooking() could not place, kept until saved
+    struct SkippedBooking {
+        Booking stay;
+        const char* reason;
+    };
+    int skippedOnLoad;
+    map<string, int> skipReasons;      // skippedOnLoad by reason
+    vector<SkippedBooking> skippedBookings;
+    bool snapshotLocked;               // skipped bookings could not be saved
+    int bookingCount;
+    Booking* head;
+    Booking* tail;
+    BookingPool pool;
+    CheckoutHistory recentCheckouts;
+    ofstream checkoutArchive;      // written by flushArchive() only
+    long long archivedCheckouts;
+    WaitingList waitingLists[ROOM_TYPE_COUNT];
+    unordered_map<string, Booking*> waitingByName;   // guest chains, as nameBookingMap
+    long long waitSeq;
+    // Per-room interval index: bookings keyed by check-in date. Stays in one
+    // room never overlap, so they are also ordered by check-out date.
+    vector<map<Date, Booking*>> roomSchedule;
+    // Guest index keyed by normalizeName(). Each entry is the head of that
+    // guest's chain of bookings (Booking::guestNext/guestPrev).
+    unordered_map<string, Booking*> nameBookingMap;
+    NameTrie nameTrie;
+    set<Booking*, BookingNameOrder> bookingsByName;
+    set<Booking*, BookingCheckInOrder> bookingsByCheckIn;
+    long long journalSeq;
+    int journalRecords;
+    // Background persistence, see PersistOptions. Mutations queue their
+    // journal records in journalPending; persistLoop() writes them out and
+    // runs the compactions, so no desk waits on the disk unless durable.
+    PersistOptions persistOptions;
+    JournalFile journal;
+    string journalPending;
+    int journalPendingRecords;
+    string archivePending;         // checkouts for <hotel>_checkouts.txt
+    long long journalQueuedSeq;    // last record queued
+    long long journalWrittenSeq;   // last record written (and synced if durable)
+    int commitWaiters;
+    bool compactionRequested;
+    bool journalFailing;            // the last write failed; its batch is queued again
+    long long journalFailures;      // failed writes so far
+    long long journalFailuresShown; // ... of which the desks have been told
+    long long snapshotFailures;     // compactions whose snapshot was not written
+    long long snapshotFailuresShown;
+    bool persisterStopping;
+    mutex journalLock;             // the journal queue fields above
+    condition_variable persistWake;
+    condition_variable journalWritten;
+    thread persister;
+    // Concurrency: one writer or any number of readers. Public methods take
+    // stateLock themselves and private helpers expect it to be held. Readers
+    // get copies of bookings (Booking::detached), never pointers into the
+    // live lists, and the menus drop the lock before prompting. Room
+    // inventory and hotelName are fixed after construction.
+    mutable shared_mutex stateLock;
+    mutable mutex freeRoomsLock;   // readers refreshing the freeRooms cache
+    mutex persistLock;             // one writer of the data files at a time
+    // Hotels may load in parallel, so messages from loading are kept here
+    // until the owner prints them (takeStartupLog)
+    bool loading;
+    mutable ostringstream startupLog;
+
+    ostream& console() const {
+        return loading ? startupLog : notices();
+    }
+
+    typedef shared_lock<shared_mutex> ReadGuard;
+
+    // Exclusive access for a mutation. In durable mode the mutation then
+    // waits, with the lock released, until its journal records are synced.
+    class WriteGuard {
+    private:
+        HotelSystem& hotel;
+        unique_lock<shared_mutex> lock;
+        long long startSeq;
+
+    public:
+        explicit WriteGuard(HotelSystem& h) : hotel(h), lock(h.stateLock), startSeq(h.journalSeq) {}
+
+        ~WriteGuard() {
+            long long seq = hotel.journalSeq;
+            lock.unlock();
+            if (hotel.persistOptions.durable && seq > startSeq && !hotel.waitForJournal(seq)) {
+                hotel.console() << RED << "Error: Could not write to journal. This change is not on disk yet."
+                                << RESET << "\n";
+            }
+        }
+    };
+
+    // Bookings as laid out in <hotel>_bookings.bin
+    struct SnapshotImage {
+        SnapshotHeader header;
+        vector<SnapshotRecord> records;
+        string strings;
+        string availability;
+        int journalRecords;   // journal records the image already contains
+    };
+
+    void printLine(string color = CYAN) {
+        cout << color << "----------------------------------------------------------------" << RESET << "\n";
+    }
+
+    // Is room free for the stay [checkIn, checkOut)? Only the last stay that
+    // starts before checkOut can overlap, so this is one O(log n) lookup.
+    bool isRoomAvailable(int roomNo, const Date& checkIn, const Date& checkOut) const {
+        if (!roomExists(roomNo)) return false;
+
+        const map<Date, Booking*>& schedule = roomSchedule[roomNo];
+        auto it = schedule.lower_bound(checkOut);
+        if (it == schedule.begin()) return true;
+        --it;
+        return it->second->checkOutDate <= checkIn;
+    }
+
+    bool isRoomFreeOn(int roomNo, const Date& night) const {
+        const map<Date, Booking*>& schedule = roomSchedule[roomNo];
+        auto it = schedule.upper_bound(night);
+        if (it == schedule.begin()) return true;
+        --it;
+        return it->second->checkOutDate <= night;
+    }
+
+    bool roomExists(int roomNo) const {
+        return roomNo >= 1 && roomNo <= maxRoomNo && roomTypeOf[roomNo] != -1;
+    }
+
+    // See RoomAvailability::findRoom()
+    int findAvailableRoomByType(int type, const Date& checkIn, const Date& checkOut) const {
+        return availability.findRoom(type, checkIn, checkOut);
+    }
+
+    // Brings freeRooms up to date for tonight. Bookings keep it current
+    // between calls, so this only does work once a day. Readers call it
+    // holding freeRoomsLock as well as the read lock.
+    void refreshFreeRooms() const {
+        Date today = getCurrentDate();
+        if (today == freeNight) return;
+        freeNight = today;
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            freeRooms[t].resize(roomsByType[t].size());
+            for (size_t i = 0; i < roomsByType[t].size(); i++) {
+                if (isRoomFreeOn(roomsByType[t][i], today)) freeRooms[t].set(i);
+            }
+        }
+    }
+
+    bool coversFreeNight(const Booking* b) const {
+        return b->checkInDate <= freeNight && freeNight < b->checkOutDate;
+    }
+
+    void addRoom(int roomNo, int type) {
+        if (roomNo > maxRoomNo) {
+            maxRoomNo = roomNo;
+            roomTypeOf.resize(roomNo + 1, -1);
+        }
+        if (roomTypeOf[roomNo] != -1) return;
+        roomTypeOf[roomNo] = type;
+        totalRooms++;
+    }
+
+    // <hotel>_rooms.txt lists the inventory, one "<room>,<type>" or
+    // "<first>-<last>,<type>" per line ('#' starts a comment). Without it the
+    // hotel gets defaultRooms rooms laid out as DEFAULT_LAYOUT. Files from
+    // before room inventories booked rooms 1 to DEFAULT_ROOMS in every hotel,
+    // so a smaller hotel starts with those too; dropUnusedLegacyRooms()
+    // removes the ones no stored booking turns out to use.
+    void loadRoomInventory(int defaultRooms) {
+        totalRooms = 0;
+        maxRoomNo = 0;
+        legacyRoomsFrom = 0;
+        roomTypeOf.assign(1, -1);
+
+        ifstream fin(dataFile("_rooms.txt"));
+        string line;
+        int lineNo = 0;
+        while (fin && getline(fin, line)) {
+            lineNo++;
+            line = line.substr(0, line.find('#'));
+            if (line.find_first_not_of(" \t\r") == string::npos) continue;
+
+            size_t comma = line.find(',');
+            int first = 0, last = 0;
+            int type = -1;
+            if (comma != string::npos) {
+                string range = line.substr(0, comma);
+                size_t dash = range.find('-');
+                first = atoi(range.c_str());
+                last = dash == string::npos ? first : atoi(range.c_str() + dash + 1);
+                string typeName = line.substr(comma + 1);
+                typeName.erase(0, typeName.find_first_not_of(" \t"));
+                typeName.erase(typeName.find_last_not_of(" \t\r") + 1);
+                type = findRoomTypeIndex(typeName);
+            }
+            if (type == -1 || first < 1 || last < first) {
+                console() << RED << "Warning: " << dataFile("_rooms.txt") << " line " << lineNo
+                          << " is not \"<room>[-<room>],<type>\"; skipped." << RESET << "\n";
+                continue;
+            }
+            for (int roomNo = first; roomNo <= last; roomNo++) {
+                addRoom(roomNo, type);
+            }
+        }
+
+        if (totalRooms == 0) {
+            for (int roomNo = 1; roomNo <= max(defaultRooms, DEFAULT_ROOMS); roomNo++) {
+                addRoom(roomNo, DEFAULT_LAYOUT[(roomNo - 1) % DEFAULT_LAYOUT_SIZE]);
+            }
+            if (defaultRooms < DEFAULT_ROOMS) legacyRoomsFrom = defaultRooms + 1;
+        }
+
+        roomSchedule.assign(maxRoomNo + 1, map<Date, Booking*>());
+        indexRooms();
+    }
+
+    // Once the stored bookings are in, keeps only the legacy rooms they use
+    void dropUnusedLegacyRooms() {
+        if (legacyRoomsFrom == 0) return;
+        for (int roomNo = legacyRoomsFrom; roomNo <= maxRoomNo; roomNo++) {
+            if (roomSchedule[roomNo].empty()) {
+                roomTypeOf[roomNo] = -1;
+                totalRooms--;
+            }
+        }
+        while (maxRoomNo > 0 && roomTypeOf[maxRoomNo] == -1) {
+            maxRoomNo--;
+        }
+        legacyRoomsFrom = 0;
+        indexRooms();
+    }
+
+    // Rebuilds the per-type room lists and everything addressed by their
+    // slots from roomTypeOf and the bookings
+    void indexRooms() {
+        roomSlot.assign(maxRoomNo + 1, -1);
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            roomsByType[t].clear();
+        }
+        for (int roomNo = 1; roomNo <= maxRoomNo; roomNo++) {
+            int type = roomTypeOf[roomNo];
+            if (type == -1) continue;
+            roomSlot[roomNo] = roomsByType[type].size();
+            roomsByType[type].push_back(roomNo);
+        }
+        availability.reset(roomsByType);
+        for (Booking* b = head; b; b = b->next) {
+            availability.add(roomTypeOf[b->roomNo], roomSlot[b->roomNo], b->checkInDate, b->checkOutDate);
+        }
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            freeRooms[t].resize(roomsByType[t].size());
+        }
+        freeNight = Date();
+    }
+
+    // Bookings form a doubly linked list with a tail pointer, so appending
+    // and unlinking a node the indexes already point to are both O(1)
+    void insertBookingNode(Booking* newBooking) {
+        newBooking->next = nullptr;
+        newBooking->prev = tail;
+        if (tail) {
+            tail->next = newBooking;
+        } else {
+            head = newBooking;
+        }
+        tail = newBooking;
+    }
+
+    void removeBookingNode(Booking* node) {
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        } else {
+            tail = node->prev;
+        }
+        node->next = nullptr;
+        node->prev = nullptr;
+    }
+
+    static void linkGuest(unordered_map<string, Booking*>& index, const string& key, Booking* b) {
+        Booking*& guestHead = index[key];
+        b->guestPrev = nullptr;
+        b->guestNext = guestHead;
+        if (guestHead) guestHead->guestPrev = b;
+        guestHead = b;
+    }
+
+    static void unlinkGuest(unordered_map<string, Booking*>& index, const string& key, Booking* b) {
+        if (b->guestNext) b->guestNext->guestPrev = b->guestPrev;
+        if (b->guestPrev) {
+            b->guestPrev->guestNext = b->guestNext;
+        } else if (b->guestNext) {
+            index[key] = b->guestNext;
+        } else {
+            index.erase(key);
+        }
+        b->guestNext = nullptr;
+        b->guestPrev = nullptr;
+    }
+
+    // Loyalty tier for the waiting list: the guest's live bookings, up to 3
+    int loyaltyTierOf(const string& key) const {
+        auto it = nameBookingMap.find(key);
+        int tier = 0;
+        for (Booking* b = it == nameBookingMap.end() ? nullptr : it->second; b && tier < 3; b = b->guestNext) {
+            tier++;
+        }
+        return tier;
+    }
+
+    // Refiles the stays a guest still waits for under their current tier,
+    // which goes up with each booking and down again as bookings go
+    void refreshWaitingTier(const string& key) {
+        auto it = waitingByName.find(key);
+        if (it == waitingByName.end()) return;
+
+        int tier = loyaltyTierOf(key);
+        for (Booking* w = it->second; w; w = w->guestNext) {
+            if (w->waitTier == tier) continue;
+            int type = findRoomTypeIndex(w->roomType);
+            waitingLists[type].setLoyaltyTier(w, tier);
+        }
+    }
+
+    // Adds a stay to every index. roomSchedule and availability hold stays
+    // of at least one night, one per check-in date of a room, so anything
+    // else is refused (returns false) and left for the caller to release.
+    bool linkBooking(Booking* b) {
+        if (!(b->checkInDate < b->checkOutDate) || roomSchedule[b->roomNo].count(b->checkInDate)) return false;
+        insertBookingNode(b);
+        availability.add(roomTypeOf[b->roomNo], roomSlot[b->roomNo], b->checkInDate, b->checkOutDate);
+        roomSchedule[b->roomNo][b->checkInDate] = b;
+        if (coversFreeNight(b)) freeRooms[roomTypeOf[b->roomNo]].reset(roomSlot[b->roomNo]);
+        string key = normalizeName(b->name);
+        linkGuest(nameBookingMap, key, b);
+        nameTrie.insert(key);
+        bookingsByName.insert(b);
+        bookingsByCheckIn.insert(b);
+        bookingCount++;
+        refreshWaitingTier(key);
+        return true;
+    }
+
+    void unlinkBooking(Booking* b) {
+        string key = normalizeName(b->name);
+        unlinkGuest(nameBookingMap, key, b);
+        refreshWaitingTier(key);
+        nameTrie.erase(key);
+        roomSchedule[b->roomNo].erase(b->checkInDate);
+        availability.remove(roomTypeOf[b->roomNo], roomSlot[b->roomNo], b->checkInDate, b->checkOutDate);
+        // Stays in a room never overlap, so nothing else covers that night
+        if (coversFreeNight(b)) freeRooms[roomTypeOf[b->roomNo]].set(roomSlot[b->roomNo]);
+        bookingsByName.erase(b);
+        bookingsByCheckIn.erase(b);
+        removeBookingNode(b);
+        bookingCount--;
+    }
+
+    void writeLine(const char* color) {
+        screen << color << "----------------------------------------------------------------" << RESET << "\n";
+    }
+
+    void writeBookingHeader() {
+        writeLine(BLUE);
+        screen << BOLDWHITE;
+        screen.cell("Room", 8).cell("Customer", 20).cell("Type", 15).cell("Check-in", 12)
+              .cell("Check-out", 12).cell("Days", 8).cell("Amount", 12) << RESET << "\n";
+        writeLine(BLUE);
+    }
+
+    void writeBookingRow(const Booking* b) {
+        screen << YELLOW;
+        screen.cell(b->roomNo, 8) << RESET;
+        screen.cell(b->name, 20).cell(b->roomType, 15).cell(b->checkInDate, 12)
+              .cell(b->checkOutDate, 12).cell(b->numDays, 8) << GREEN;
+        screen.money(b->totalAmount) << RESET << "\n";
+    }
+
+    // Flushes the page so far and asks whether to show more
+    bool nextPage(int shown, int total) {
+        screen << YELLOW << "-- " << shown << " of " << total
+               << " shown. Press Enter for more, or q to stop: " << RESET;
+        screen.flush();
+        string answer;
+        return getline(cin, answer) && answer != "q" && answer != "Q";
+    }
+
+    void writeBookingTable(const vector<Booking>& rows) {
+        writeBookingHeader();
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (i > 0 && i % BOOKING_PAGE_SIZE == 0 && !nextPage(i, rows.size())) break;
+            writeBookingRow(&rows[i]);
+        }
+        writeLine(BLUE);
+    }
+
+    // Offers the gap that freeing [from, to) opened in a room to the guests
+    // waiting for its room type, best priority first, until nobody left in
+    // that queue fits what remains of it. Guests only wait when no room fit
+    // them, so the room's other gaps need not be looked at. The new
+    // bookings are added to assigned when it is given.
+    bool assignFromWaitingList(int roomNo, const Date& from, vector<Booking>* assigned) {
+        if (!roomExists(roomNo)) return false;
+        int type = roomTypeOf[roomNo];
+
+        struct Gap {
+            Date from;   // Date() when nothing is booked before it
+            Date to;
+            bool open;   // nothing booked after it
+        };
+        const map<Date, Booking*>& schedule = roomSchedule[roomNo];
+        auto after = schedule.lower_bound(from);
+        vector<Gap> gaps(1, Gap{after == schedule.begin() ? Date() : std::prev(after)->second->checkOutDate,
+                                after == schedule.end() ? Date() : after->first, after == schedule.end()});
+
+        bool any = false;
+        while (!gaps.empty()) {
+            Gap gap = gaps.back();
+            gaps.pop_back();
+            Booking* w = waitingLists[type].takeBest(gap.from, gap.open ? nullptr : &gap.to);
+            if (!w) continue;
+            gaps.push_back(Gap{gap.from, w->checkInDate, false});
+            gaps.push_back(Gap{w->checkOutDate, gap.to, gap.open});
+            unlinkGuest(waitingByName, normalizeName(w->name), w);
+
+            // The waiting node itself becomes the booking
+            w->roomNo = roomNo;
+            w->totalAmount = ROOM_TYPES[type].price * w->numDays;
+            if (!linkBooking(w)) {
+                pool.release(w);
+                continue;
+            }
+            journalAdd(w);
+            if (assigned) assigned->push_back(Booking::detached(w));
+            any = true;
+        }
+        return any;
+    }
+
+    void showAssigned(const vector<Booking>& assigned) {
+        for (const Booking& b : assigned) {
+            cout << GREEN << "\n[Waiting List] Assigned room " << b.roomNo
+                 << " to " << b.name << " (Rs" << fixed << setprecision(2)
+                 << b.totalAmount << " for " << b.numDays << " days)" << RESET << "\n";
+        }
+    }
+
+    void writeBookingDetails(const Booking* b) {
+        screen << "Customer Name: " << BOLDWHITE << b->name << RESET << "\n";
+        screen << "Room Number: " << CYAN << b->roomNo << RESET << "\n";
+        screen << "Room Type: " << YELLOW << b->roomType << RESET << "\n";
+        screen << "Check-in Date: " << b->checkInDate << "\n";
+        screen << "Check-out Date: " << b->checkOutDate << "\n";
+        screen << "Number of Days: " << b->numDays << "\n";
+        screen << "Total Amount: " << GREEN;
+        screen.money(b->totalAmount) << RESET << "\n";
+    }
+
+    // Search results as detail blocks, SEARCH_PAGE_SIZE to a page
+    void writeBookingDetailPages(const vector<Booking>& stays) {
+        for (size_t i = 0; i < stays.size(); i++) {
+            if (i > 0 && i % SEARCH_PAGE_SIZE == 0 && !nextPage(i, stays.size())) break;
+            writeLine(GREEN);
+            writeBookingDetails(&stays[i]);
+        }
+        writeLine(GREEN);
+        screen.flush();
+    }
+
+    // Pick one of a room's bookings; asks which stay when there are several.
+    // Returns false when the room has none.
+    bool selectRoomBooking(int roomNo, Booking& chosen) {
+        vector<Booking> stays = getRoomBookings(roomNo);
+        if (stays.empty()) return false;
+        if (stays.size() == 1) {
+            chosen = stays[0];
+            return true;
+        }
+
+        cout << YELLOW << "Room " << roomNo << " has " << stays.size() << " bookings:" << RESET << "\n";
+        for (size_t i = 0; i < stays.size(); i++) {
+            cout << CYAN << i + 1 << ". " << RESET << stays[i].name
+                 << " | " << stays[i].checkInDate.toString() << " - " << stays[i].checkOutDate.toString() << "\n";
+        }
+        int choice = readInt("Select booking (1-" + to_string(stays.size()) + "): ", 1, (int)stays.size());
+        chosen = stays[choice - 1];
+        return true;
+    }
+
+    // The live booking for a stay, or nullptr if another desk removed it
+    Booking* findStay(int roomNo, const Date& checkIn) const {
+        if (!roomExists(roomNo)) return nullptr;
+        auto it = roomSchedule[roomNo].find(checkIn);
+        return it == roomSchedule[roomNo].end() ? nullptr : it->second;
+    }
+
+    string dataFile(const string& suffix) const {
+        return dataFile(hotelName, suffix);
+    }
+
+    // Parses the fields writeBookingFields() writes. Returns nullptr on
+    // success, otherwise what is wrong with the line.
+    static const char* parseBookingFields(string_view line, Booking& b) {
+        if (count(line.begin(), line.end(), ',') != 6) return "expected 7 comma-separated fields";
+
+        string_view name = nextField(line);
+        string_view roomNo = nextField(line);
+        string_view roomType = nextField(line);
+        string_view checkIn = nextField(line);
+        string_view checkOut = nextField(line);
+        string_view numDays = nextField(line);
+        string_view amount = trimView(line);
+
+        if (name.empty()) return "empty guest name";
+        if (!parseNumber(roomNo, b.roomNo)) return "room number is not a number";
+        if (findRoomTypeIndex(string(roomType)) == -1) return "unknown room type";
+        b.checkInDate = parseDate(checkIn);
+        if (b.checkInDate == Date()) return "check-in is not a DD/MM/YYYY date";
+        b.checkOutDate = parseDate(checkOut);
+        if (b.checkOutDate == Date()) return "check-out is not a DD/MM/YYYY date";
+        if (!(b.checkInDate < b.checkOutDate)) return "check-out is not after check-in";
+        if (!parseNumber(numDays, b.numDays)) return "day count is not a number";
+        if (!parseNumber(amount, b.totalAmount)) return "amount is not a number";
+
+        b.name.assign(name.data(), name.size());
+        b.roomType.assign(roomType.data(), roomType.size());
+        return nullptr;
+    }
+
+    void warnBadLine(const string& filename, int lineNo, const char* problem) {
+        console() << RED << "Warning: " << filename << " line " << lineNo << ": " << problem
+                  << "; skipped." << RESET << "\n";
+    }
+
+    // Parses a stored booking line into a pool node and loads it
+    void loadBookingLine(string_view line, const string& filename, int lineNo) {
+        Booking* b = pool.acquire();
+        const char* problem = parseBookingFields(line, *b);
+        if (problem) {
+            warnBadLine(filename, lineNo, problem);
+            pool.release(b);
+            return;
+        }
+        loadBooking(b);
+    }
+
+    // Takes ownership of a node read from disk: links it if it is a valid
+    // stay that fits the room's schedule, otherwise keeps a copy for
+    // saveSkippedBookings() and returns it to the pool. A stay that starts
+    // the day another one in the room does is a conflict, whatever its
+    // length: roomSchedule holds one stay per check-in.
+    void loadBooking(Booking* b) {
+        const char* reason = nullptr;
+        if (!b->checkInDate.isValid() || !b->checkOutDate.isValid()) {
+            reason = "dated outside 2024-2100";
+        } else if (!(b->checkInDate < b->checkOutDate)) {
+            reason = "ending before they start";
+        } else if (!roomExists(b->roomNo)) {
+            reason = "in rooms the hotel does not have";
+        } else if (!isRoomAvailable(b->roomNo, b->checkInDate, b->checkOutDate)) {
+            reason = "overlapping another stay";
+        } else if (!linkBooking(b)) {
+            reason = "sharing a check-in with another stay";
+        }
+        if (!reason) return;
+        skippedOnLoad++;
+        skipReasons[reason]++;
+        skippedBookings.push_back(SkippedBooking{Booking::detached(b), reason});
+        pool.release(b);
+    }
+
+    // Appends the bookings loadBooking() could not place to
+    // <hotel>_skipped.txt, in the bookings CSV format, so that compacting
+    // them out of the snapshot loses nothing
+    bool saveSkippedBookings() {
+        ofstream fout(dataFile("_skipped.txt"), ios::app);
+        for (const SkippedBooking& skipped : skippedBookings) {
+            writeBookingFields(fout, &skipped.stay);
+            fout << "\n";
+        }
+        fout.close();
+        if (!fout) return false;
+        skippedBookings.clear();
+        return true;
+    }
+
+    // Journal records are "<seq>,+,<booking fields>" for a new booking and
+    // "<seq>,-,<room>,<check-in>" for a cancellation or checkout. The snapshot
+    // header stores the last sequence number it already contains.
+    // Records are only queued here; persistLoop() writes them.
+    void journalAppend(const string& record) {
+        bool compactionDue = ++journalRecords >= max(JOURNAL_MIN_COMPACT, bookingCount);
+        lock_guard<mutex> queue(journalLock);
+        reportPersistFailures();
+
+        journalPending += to_string(++journalSeq);
+        journalPending += ',';
+        journalPending += record;
+        journalPending += '\n';
+        journalQueuedSeq = journalSeq;
+        if (compactionDue) compactionRequested = true;
+        if (++journalPendingRecords >= persistOptions.flushBatch || compactionDue) {
+            persistWake.notify_one();
+        }
+    }
+
+    // Tells the desk about journal and snapshot writes that failed since it
+    // was last told; needs journalLock. The persister thread never prints,
+    // as cout is not synchronised with the desks.
+    void reportPersistFailures() {
+        if (journalFailuresShown != journalFailures) {
+            console() << RED << "Error: Could not write to journal. Changes are kept in memory and retried."
+                      << RESET << "\n";
+            journalFailuresShown = journalFailures;
+        }
+        if (snapshotFailuresShown != snapshotFailures) {
+            console() << RED << "Error: Could not save " << dataFile("_bookings.bin")
+                      << ". The journal keeps every change until it can be." << RESET << "\n";
+            snapshotFailuresShown = snapshotFailures;
+        }
+    }
+
+    // Writes the queued records in one go, synced in durable mode. A batch
+    // that could not be written goes back to the front of the queue.
+    bool flushJournal() {
+        lock_guard<mutex> persisting(persistLock);
+        string batch;
+        int records;
+        long long seq;
+        {
+            lock_guard<mutex> queue(journalLock);
+            if (journalPending.empty()) return true;
+            batch.swap(journalPending);
+            records = journalPendingRecords;
+            journalPendingRecords = 0;
+            seq = journalQueuedSeq;
+        }
+        bool written = journal.append(dataFile("_journal.txt"), batch, persistOptions.durable);
+
+        lock_guard<mutex> queue(journalLock);
+        if (written) {
+            journalWrittenSeq = seq;
+            journalFailing = false;
+        } else {
+            journalPending.insert(0, batch);
+            journalPendingRecords += records;
+            journalFailing = true;
+            journalFailures++;
+        }
+        journalWritten.notify_all();
+        return written;
+    }
+
+    // False if a write failed before the record up to seq got out
+    bool waitForJournal(long long seq) {
+        unique_lock<mutex> queue(journalLock);
+        long long failures = journalFailures;
+        commitWaiters++;
+        persistWake.notify_one();
+        journalWritten.wait(queue, [this, seq, failures] {
+            return journalWrittenSeq >= seq || journalFailures != failures;
+        });
+        commitWaiters--;
+        journalFailuresShown = journalFailures;
+        return journalWrittenSeq >= seq;
+    }
+
+    // The hotel's persistence thread: flushes the journal every
+    // flushIntervalMs, when a batch is full or a durable commit is
+    // waiting, and compacts when the journal has grown enough. Archived
+    // checkouts go out with each flush.
+    void persistLoop() {
+        unique_lock<mutex> queue(journalLock);
+        while (!persisterStopping) {
+            persistWake.wait_for(queue, chrono::milliseconds(persistOptions.flushIntervalMs), [this] {
+                return persisterStopping || compactionRequested || commitWaiters > 0 ||
+                       (!journalFailing && journalPendingRecords >= persistOptions.flushBatch);
+            });
+            bool compactNow = compactionRequested;
+            compactionRequested = false;
+            queue.unlock();
+            flushJournal();
+            flushArchive();
+            if (compactNow) compact();
+            queue.lock();
+        }
+    }
+
+    // Spills a checkout out of memory into the append-only archive. The
+    // record is queued like a journal record; flushArchive() writes it.
+    void archiveCheckout(Booking* b) {
+        ostringstream rec;
+        writeBookingFields(rec, b);
+        rec << "\n";
+        archivedCheckouts++;
+        pool.release(b);
+        lock_guard<mutex> queue(journalLock);
+        archivePending += rec.str();
+    }
+
+    // Appends the queued checkouts to the archive. A batch that could not
+    // be written is queued again for the next flush.
+    void flushArchive() {
+        lock_guard<mutex> persisting(persistLock);
+        string batch;
+        {
+            lock_guard<mutex> queue(journalLock);
+            if (archivePending.empty()) return;
+            batch.swap(archivePending);
+        }
+        if (!checkoutArchive.is_open()) {
+            checkoutArchive.open(dataFile("_checkouts.txt"), ios::app);
+        }
+        checkoutArchive << batch;
+        checkoutArchive.flush();
+        if (!checkoutArchive) {
+            checkoutArchive.close();
+            checkoutArchive.clear();
+            lock_guard<mutex> queue(journalLock);
+            archivePending.insert(0, batch);
+        }
+    }
+
+    void journalAdd(const Booking* b) {
+        ostringstream rec;
+        rec << "+,";
+        writeBookingFields(rec, b);
+        journalAppend(rec.str());
+    }
+
+    void journalRemove(const Booking* b) {
+        journalAppend("-," + to_string(b->roomNo) + "," + b->checkInDate.toString());
+    }
+
+    void replayJournalRecord(string_view record, const string& filename, int lineNo) {
+        string_view seqField = nextField(record);
+        string_view op = nextField(record);
+        long long seq;
+        if (!parseNumber(seqField, seq) || (op != "+" && op != "-")) {
+            warnBadLine(filename, lineNo, "not a \"<seq>,+|-,...\" journal record");
+            return;
+        }
+        if (seq <= journalSeq) return;
+        journalSeq = seq;
+        journalRecords++;
+
+        if (op == "+") {
+            loadBookingLine(record, filename, lineNo);
+            return;
+        }
+
+        int roomNo;
+        string_view roomField = nextField(record);
+        Date checkIn = parseDate(record);
+        if (!parseNumber(roomField, roomNo) || checkIn == Date()) {
+            warnBadLine(filename, lineNo, "removal is not \"<room>,<check-in>\"");
+            return;
+        }
+        if (roomExists(roomNo)) {
+            auto it = roomSchedule[roomNo].find(checkIn);
+            if (it != roomSchedule[roomNo].end()) {
+                Booking* b = it->second;
+                unlinkBooking(b);
+                pool.release(b);
+                return;
+            }
+        }
+        // The stay may be one that was skipped earlier in the load
+        auto skipped = find_if(skippedBookings.begin(), skippedBookings.end(), [&](const SkippedBooking& b) {
+            return b.stay.roomNo == roomNo && b.stay.checkInDate == checkIn;
+        });
+        if (skipped != skippedBookings.end()) {
+            if (--skipReasons[skipped->reason] == 0) skipReasons.erase(skipped->reason);
+            skippedBookings.erase(skipped);
+            skippedOnLoad--;
+        }
+    }
+
+    static SnapshotDate packDate(const Date& d) {
+        SnapshotDate packed;
+        packed.day = (uint8_t)d.day();
+        packed.month = (uint8_t)d.month();
+        packed.year = (uint16_t)d.year();
+        return packed;
+    }
+
+    static Date unpackDate(const SnapshotDate& packed) {
+        return Date(packed.day, packed.month, packed.year);
+    }
+
+    // Copies the live bookings into a snapshot image; needs the read lock
+    void captureSnapshot(SnapshotImage& image) const {
+        image.records.clear();
+        image.records.reserve(bookingCount);
+        image.strings.clear();
+        unordered_map<string, uint32_t> stringOffsets;
+        auto intern = [&](const string& str) {
+            auto it = stringOffsets.find(str);
+            if (it != stringOffsets.end()) return it->second;
+            uint32_t offset = (uint32_t)image.strings.size();
+            image.strings += str;
+            stringOffsets[str] = offset;
+            return offset;
+        };
+
+        for (Booking* b = head; b; b = b->next) {
+            SnapshotRecord rec;
+            memset(&rec, 0, sizeof(rec));
+            rec.nameOffset = intern(b->name);
+            rec.nameLength = (uint32_t)b->name.size();
+            rec.typeOffset = intern(b->roomType);
+            rec.typeLength = (uint32_t)b->roomType.size();
+            rec.roomNo = b->roomNo;
+            rec.numDays = b->numDays;
+            rec.checkIn = packDate(b->checkInDate);
+            rec.checkOut = packDate(b->checkOutDate);
+            rec.totalAmount = b->totalAmount;
+            image.records.push_back(rec);
+        }
+        image.availability.clear();
+        availability.save(image.availability);
+
+        SnapshotHeader& header = image.header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.recordCount = (uint32_t)image.records.size();
+        header.journalSeq = journalSeq;
+        header.stringTableSize = (uint32_t)image.strings.size();
+        header.availabilitySize = (uint32_t)image.availability.size();
+        image.journalRecords = journalRecords;
+    }
+
+    // Writes the image through a temporary file; needs no lock. It runs on
+    // the persister thread, so failures are only returned, see compact().
+    bool writeSnapshot(const SnapshotImage& image) const {
+        string filename = dataFile("_bookings.bin");
+        string tmpname = filename + ".tmp";
+
+        ofstream fout(tmpname, ios::binary | ios::trunc);
+        if (!fout) return false;
+        fout.write((const char*)&image.header, sizeof(image.header));
+        fout.write((const char*)image.records.data(), image.records.size() * sizeof(SnapshotRecord));
+        fout.write(image.strings.data(), image.strings.size());
+        fout.write(image.availability.data(), image.availability.size());
+        fout.close();
+
+        // In durable mode the data must be on disk before the rename can
+        // replace the old snapshot, and the rename before compact() empties
+        // the journal
+        if (!fout || (persistOptions.durable && !syncFile(tmpname))) return false;
+        if (rename(tmpname.c_str(), filename.c_str()) != 0) {
+            remove(filename.c_str());
+            if (rename(tmpname.c_str(), filename.c_str()) != 0) return false;
+        }
+        return !persistOptions.durable || syncDirectoryOf(filename);
+    }
+
+    // Returns false when there is no usable binary snapshot
+    bool loadBinarySnapshot(long long& snapshotSeq) {
+        MappedFile file;
+        if (!file.open(dataFile("_bookings.bin"))) return false;
+
+        const char* base = file.data();
+        if (file.size() < sizeof(SnapshotHeader)) return false;
+
+        const SnapshotHeader* header = (const SnapshotHeader*)base;
+        if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+            (header->version != SNAPSHOT_VERSION && header->version != 1)) {
+            console() << RED << "Error: Unrecognised snapshot " << dataFile("_bookings.bin") << "." << RESET << "\n";
+            return false;
+        }
+
+        size_t recordsSize = (size_t)header->recordCount * sizeof(SnapshotRecord);
+        if (file.size() != sizeof(SnapshotHeader) + recordsSize + header->stringTableSize + header->availabilitySize) {
+            console() << RED << "Error: Truncated snapshot " << dataFile("_bookings.bin") << "." << RESET << "\n";
+            return false;
+        }
+
+        const SnapshotRecord* records = (const SnapshotRecord*)(base + sizeof(SnapshotHeader));
+        const char* strings = base + sizeof(SnapshotHeader) + recordsSize;
+
+        for (uint32_t i = 0; i < header->recordCount; i++) {
+            const SnapshotRecord& rec = records[i];
+            if ((uint64_t)rec.nameOffset + rec.nameLength > header->stringTableSize ||
+                (uint64_t)rec.typeOffset + rec.typeLength > header->stringTableSize) {
+                continue;
+            }
+
+            Booking* b = pool.acquire();
+            b->name.assign(strings + rec.nameOffset, rec.nameLength);
+            b->roomType.assign(strings + rec.typeOffset, rec.typeLength);
+            b->roomNo = rec.roomNo;
+            b->numDays = rec.numDays;
+            b->checkInDate = unpackDate(rec.checkIn);
+            b->checkOutDate = unpackDate(rec.checkOut);
+            b->totalAmount = rec.totalAmount;
+            loadBooking(b);
+        }
+
+        snapshotSeq = header->journalSeq;
+        return true;
+    }
+
+    // CSV import path, used when no binary snapshot exists yet
+    void importCsv(const string& filename, long long& snapshotSeq) {
+        ifstream fin(filename);
+        string line;
+        int lineNo = 0;
+
+        while (fin && getline(fin, line)) {
+            lineNo++;
+            string_view view = trimView(line);
+            if (view.empty()) continue;
+            if (view[0] == '#') {
+                if (!parseNumber(view.substr(1), snapshotSeq)) {
+                    warnBadLine(filename, lineNo, "header is not \"#<seq>\"");
+                }
+                continue;
+            }
+            loadBookingLine(view, filename, lineNo);
+        }
+    }
+
+    void loadFromFile() {
+        long long snapshotSeq = 0;
+        bool fromBinary = loadBinarySnapshot(snapshotSeq);
+        if (!fromBinary) {
+            importCsv(dataFile("_bookings.txt"), snapshotSeq);
+        }
+
+        journalSeq = snapshotSeq;
+        string line;
+        string journalFile = dataFile("_journal.txt");
+        ifstream jin(journalFile);
+        int lineNo = 0;
+        while (jin && getline(jin, line)) {
+            lineNo++;
+            string_view view = trimView(line);
+            if (!view.empty()) replayJournalRecord(view, journalFile, lineNo);
+        }
+        jin.close();
+        dropUnusedLegacyRooms();
+
+        // Skipped bookings are compacted away once they are saved elsewhere;
+        // until then the snapshot that still holds them is left alone
+        if (!skippedBookings.empty() && !saveSkippedBookings()) {
+            console() << RED << "Error: Could not save skipped bookings to " << dataFile("_skipped.txt")
+                      << "; " << dataFile("_bookings.bin") << " will not be rewritten." << RESET << "\n";
+            snapshotLocked = true;
+        }
+
+        // A CSV import is converted to a binary snapshot straight away
+        if ((!fromBinary && bookingCount > 0) || skippedOnLoad > 0 ||
+            journalRecords >= max(JOURNAL_MIN_COMPACT, bookingCount)) {
+            compact();
+        }
+    }
+
+public:
+    HotelSystem(const string& name = "Grand Hotel", int rooms = DEFAULT_ROOMS,
+                const PersistOptions& options = PersistOptions())
+        : hotelName(name), totalRooms(0), maxRoomNo(0), legacyRoomsFrom(0), skippedOnLoad(0), snapshotLocked(false), bookingCount(0),
+          archivedCheckouts(0), waitSeq(0), journalSeq(0), journalRecords(0), persistOptions(options),
+          journalPendingRecords(0), journalQueuedSeq(0), journalWrittenSeq(0), commitWaiters(0),
+          compactionRequested(false), journalFailing(false), journalFailures(0), journalFailuresShown(0),
+          snapshotFailures(0), snapshotFailuresShown(0), persisterStopping(false), loading(true) {
+        head = nullptr;
+        tail = nullptr;
+        loadRoomInventory(rooms);
+        loadFromFile();
+        journalQueuedSeq = journalWrittenSeq = journalSeq;
+        reportPersistFailures();
+        if (skippedOnLoad > 0) {
+            console() << YELLOW << "Warning: " << skippedOnLoad << " stored bookings for " << hotelName << " were "
+                      << (snapshotLocked ? string("skipped") : "moved to " + dataFile("_skipped.txt")) << ":";
+            const char* separator = " ";
+            for (auto& reason : skipReasons) {
+                console() << separator << reason.second << " " << reason.first;
+                separator = ", ";
+            }
+            console() << "." << RESET << "\n";
+        }
+        loading = false;
+        persister = thread(&HotelSystem::persistLoop, this);
+    }
+
+    // Whatever is still queued is written before the hotel goes away
+    ~HotelSystem() {
+        {
+            lock_guard<mutex> queue(journalLock);
+            persisterStopping = true;
+            persistWake.notify_one();
+        }
+        persister.join();
+        flushJournal();
+
+        Booking* temp = head;
+        while (temp) {
+            Booking* nxt = temp->next;
+            pool.release(temp);
+            temp = nxt;
+        }
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            for (Booking* w : waitingLists[t].ordered()) {
+                pool.release(w);
+            }
+        }
+        while (Booking* b = recentCheckouts.popOldest()) {
+            archiveCheckout(b);
+        }
+        flushArchive();
+    }
+
+    string getHotelName() const {
+        return hotelName;
+    }
+
+    // Warnings from loading the hotel's files, emptied by the call
+    string takeStartupLog() {
+        string log = startupLog.str();
+        startupLog.str("");
+        return log;
+    }
+
+    // Rooms with no stay covering tonight
+    int getAvailableRooms() const {
+        ReadGuard reading(stateLock);
+        lock_guard<mutex> cache(freeRoomsLock);
+        refreshFreeRooms();
+        int available = 0;
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            available += freeRooms[t].count();
+        }
+        return available;
+    }
+
+    int getAvailableRooms(int type) const {
+        ReadGuard reading(stateLock);
+        lock_guard<mutex> cache(freeRoomsLock);
+        refreshFreeRooms();
+        return freeRooms[type].count();
+    }
+
+    int getBookingCount() const {
+        ReadGuard reading(stateLock);
+        return bookingCount;
+    }
+
+    // Rooms of the type with no bookings at all, kept current by every
+    // booking change; such a room is free for any dates
+    int getIdleRooms(int type) const {
+        ReadGuard reading(stateLock);
+        return availability.idleRooms(type);
+    }
+
+    int getTotalRooms() const {
+        return totalRooms;
+    }
+
+    // Rough bytes held by the hotel's bookings and room tables
+    size_t getMemoryEstimate() const {
+        ReadGuard reading(stateLock);
+        return pool.getCapacity() * sizeof(Booking) + bookingCount * INDEX_BYTES_PER_BOOKING +
+               nameTrie.memoryEstimate() + availability.memoryEstimate() +
+               roomSchedule.size() * (sizeof(map<Date, Booking*>) + 3 * sizeof(int));
+    }
+
+    // Waiting-list requests are not persisted, so such a hotel must stay
+    // in memory
+    bool hasWaitingGuests() const {
+        ReadGuard reading(stateLock);
+        return !waitingByName.empty();
+    }
 
-        while (temp && temp->roomNo != roomNo) {
-            prev = temp;
-            temp = temp->next;
-        }
+    int getRoomCount(int type) const {
+        return roomsByType[type].size();
+    }
 
-        if (!temp) return;
+    // Writes the live bookings as CSV; importCsv() reads the same format
+    bool exportCsv(const string& filename) const {
+        ReadGuard reading(stateLock);
+        ofstream fout(filename, ios::trunc);
+        if (!fout) return false;
 
-        if (!prev) {
-            head = temp->next;
-        } else {
-            prev->next = temp->next;
+        fout << "#" << journalSeq << "\n";
+        for (Booking* b = head; b; b = b->next) {
+            writeBookingFields(fout, b);
+            fout << "\n";
         }
-        delete temp;
+        fout.close();
+        return (bool)fout;
     }
 
-    bool assignFromWaitingList() {
-        if (waitingList.empty()) return false;
+    // Core operations shared by the interactive menus and batch mode. They
+    // expect valid dates with checkIn < checkOut and do no prompting.
+    // Finding the room and taking it happen under one write lock, so two
+    // desks can never be given the same room for overlapping stays.
+    bool bookRoom(const string& name, const Date& checkIn, const Date& checkOut, const RoomTypeInfo& type,
+                  Booking* confirmed = nullptr) {
+        WriteGuard writing(*this);
+        int typeIndex = findRoomTypeIndex(type.name);
+        int roomNo = typeIndex == -1 ? -1 : findAvailableRoomByType(typeIndex, checkIn, checkOut);
+        if (roomNo == -1) return false;
 
-        queue<Booking> newQueue;
-        bool assigned = false;
+        Booking* b = pool.acquire();
+        b->name = name;
+        b->roomNo = roomNo;
+        b->roomType = type.name;
+        b->checkInDate = checkIn;
+        b->checkOutDate = checkOut;
+        b->numDays = max(1, checkIn.daysBetween(checkOut));
+        b->totalAmount = type.price * b->numDays;
 
-        while (!waitingList.empty()) {
-            Booking w = waitingList.front();
-            waitingList.pop();
-            
-            int availableRoom = findAvailableRoom();
-            if (!assigned && availableRoom != -1) {
-                Booking* newNode = new Booking();
-                newNode->roomNo = availableRoom;
-                newNode->name = w.name;
-                newNode->checkInDate = w.checkInDate;
-                newNode->checkOutDate = w.checkOutDate;
-                newNode->numDays = w.numDays;
-                newNode->roomType = w.roomType;
-                newNode->totalAmount = ROOM_PRICES[availableRoom - 1] * w.numDays;
-                newNode->next = nullptr;
-                
-                insertBookingNode(newNode);
-                roomOccupied[availableRoom] = true;
-                roomBookingMap[availableRoom] = newNode;
-                nameBookingMap[newNode->name] = newNode;
-                bookedRooms++;
-                
-                cout << GREEN << "\n[Waiting List] Assigned room " << availableRoom 
-                     << " to " << newNode->name << " (Rs" << fixed << setprecision(2) 
-                     << newNode->totalAmount << " for " << newNode->numDays << " days)" << RESET << "\n";
-                assigned = true;
-            } else {
-                newQueue.push(w);
-            }
+        if (!linkBooking(b)) {
+            pool.release(b);
+            return false;
         }
-
-        waitingList = newQueue;
-        saveToFile();
-        return assigned;
+        journalAdd(b);
+        if (confirmed) *confirmed = Booking::detached(b);
+        return true;
     }
 
-    Date parseDate(const string& dateStr) {
-        Date d;
-        char slash1, slash2;
-        stringstream ss(dateStr);
-        ss >> d.day >> slash1 >> d.month >> slash2 >> d.year;
-        
-        if (ss.fail() || slash1 != '/' || slash2 != '/') {
-            return Date();
+    void joinWaitingList(const string& name, const Date& checkIn, const Date& checkOut, const RoomTypeInfo& type) {
+        WriteGuard writing(*this);
+        Booking* w = pool.acquire();
+        w->name = name;
+        w->roomType = type.name;
+        w->checkInDate = checkIn;
+        w->checkOutDate = checkOut;
+        w->numDays = max(1, checkIn.daysBetween(checkOut));
+        w->totalAmount = type.price * w->numDays;
+        int t = findRoomTypeIndex(type.name);
+        if (t == -1 || !(checkIn < checkOut)) {
+            pool.release(w);
+            return;
         }
-        return d;
+        string key = normalizeName(name);
+        waitingLists[t].push(w, loyaltyTierOf(key), ++waitSeq);
+        linkGuest(waitingByName, key, w);
     }
 
-    Date readDate(const string& prompt) {
-        string input;
-        Date d;
-        while (true) {
-            cout << CYAN << prompt << RESET;
-            cout.flush();
-            if (!getline(cin, input)) {
-                if (cin.eof()) {
-                    cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
-                    exit(0);
-                }
-                cin.clear();
-                continue;
-            }
-            
-            d = parseDate(input);
-            if (d.isValid()) {
-                return d;
-            }
-            cout << RED << "Invalid date format or invalid date. Please use DD/MM/YYYY format." << RESET << "\n";
+    // Drops every waiting-list request of a guest; returns how many
+    int leaveWaitingList(const string& name) {
+        WriteGuard writing(*this);
+        string key = normalizeName(name);
+        int removed = 0;
+        auto it = waitingByName.find(key);
+        while (it != waitingByName.end()) {
+            Booking* w = it->second;
+            unlinkGuest(waitingByName, key, w);
+            waitingLists[findRoomTypeIndex(w->roomType)].remove(w);
+            pool.release(w);
+            removed++;
+            it = waitingByName.find(key);
         }
+        return removed;
     }
 
-    Date getCurrentDate() {
-        time_t now = time(0);
-        tm* ltm = localtime(&now);
-        return Date(ltm->tm_mday, 1 + ltm->tm_mon, 1900 + ltm->tm_year);
+    int findRoomFor(const RoomTypeInfo& type, const Date& checkIn, const Date& checkOut) const {
+        ReadGuard reading(stateLock);
+        int typeIndex = findRoomTypeIndex(type.name);
+        return typeIndex == -1 ? -1 : findAvailableRoomByType(typeIndex, checkIn, checkOut);
     }
 
-    int readInt(const string& prompt, int minVal = INT_MIN, int maxVal = INT_MAX) {
-        int x;
-        while (true) {
-            cout << CYAN << prompt << RESET;
-            cout.flush();
-            if (cin >> x) {
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                if (x >= minVal && x <= maxVal) {
-                    return x;
-                }
-                cout << RED << "Please enter a value between " << minVal << " and " << maxVal << "." << RESET << "\n";
-            } else {
-                if (cin.eof()) {
-                    cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
-                    exit(0);
-                }
-                cout << RED << "Invalid input. Please enter a number." << RESET << "\n";
-                cin.clear();
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            }
+    // A copy of the hotel's free capacity as it stands now
+    shared_ptr<const RoomAvailability> availabilitySnapshot() const {
+        ReadGuard reading(stateLock);
+        return make_shared<RoomAvailability>(availability);
+    }
+
+    // A hotel's data file: its name with spaces as underscores, then suffix
+    static string dataFile(const string& hotel, const string& suffix) {
+        string filename = hotel + suffix;
+        for (char& c : filename) {
+            if (c == ' ') c = '_';
         }
+        return filename;
     }
 
-    string readNonEmptyString(const string& prompt) {
-        string input;
-        while (true) {
-            cout << CYAN << prompt << RESET;
-            cout.flush();
-            if (!getline(cin, input)) {
-                if (cin.eof()) {
-                    cout << "\n" << YELLOW << "End of input detected. Exiting..." << RESET << "\n";
-                    exit(0);
-                }
-                cin.clear();
-                continue;
-            }
-            
-            size_t start = input.find_first_not_of(" \t");
-            size_t end = input.find_last_not_of(" \t");
-            
-            if (start != string::npos && end != string::npos) {
-                input = input.substr(start, end - start + 1);
-                if (!input.empty()) {
-                    return input;
-                }
-            }
-            cout << RED << "Input cannot be empty. Please try again." << RESET << "\n";
+    // Deletes every file a HotelSystem may write for the hotel, for the
+    // scratch hotels of --bench and --stress
+    static void removeDataFiles(const string& hotel) {
+        const char* suffixes[] = {"_bookings.bin", "_bookings.bin.tmp", "_bookings.txt", "_journal.txt",
+                                  "_checkouts.txt", "_skipped.txt"};
+        for (const char* suffix : suffixes) {
+            remove(dataFile(hotel, suffix).c_str());
         }
     }
 
-    string toLowerCase(const string& str) {
-        string result = str;
-        for (char& c : result) {
-            c = tolower(c);
+    // The free capacity saved with a hotel's snapshot, read without loading
+    // the hotel; null if there is none or the journal holds later changes
+    static shared_ptr<const RoomAvailability> readSavedAvailability(const string& hotel) {
+        ifstream journal(dataFile(hotel, "_journal.txt"));
+        if (journal && journal.peek() != EOF) return nullptr;
+
+        MappedFile file;
+        if (!file.open(dataFile(hotel, "_bookings.bin")) || file.size() < sizeof(SnapshotHeader)) return nullptr;
+        const SnapshotHeader* header = (const SnapshotHeader*)file.data();
+        size_t offset = sizeof(SnapshotHeader) + (size_t)header->recordCount * sizeof(SnapshotRecord) +
+                        header->stringTableSize;
+        if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != SNAPSHOT_VERSION || header->availabilitySize == 0 ||
+            file.size() != offset + header->availabilitySize) {
+            return nullptr;
         }
-        return result;
+
+        shared_ptr<RoomAvailability> saved = make_shared<RoomAvailability>();
+        if (!saved->load(file.data() + offset, header->availabilitySize)) return nullptr;
+        return saved;
     }
 
-    void saveToFile() {
-        string filename = hotelName + "_bookings.txt";
-        for (char& c : filename) {
-            if (c == ' ') c = '_';
+    // Writes the queued journal and archive records now rather than at the
+    // next flush
+    void flush() {
+        flushJournal();
+        flushArchive();
+    }
+
+    // Compaction: writes a new binary snapshot and starts a fresh journal.
+    // The bookings are copied out under the read lock and written with no
+    // lock held, so desks keep working meanwhile. The journal is only
+    // truncated if nothing was appended during the write; otherwise its
+    // older records stay behind and are skipped on replay. Returns false if
+    // the snapshot could not be written; the journal then keeps every
+    // change, and the next desk to make one is told.
+    bool compact() {
+        if (snapshotLocked) return true;
+        lock_guard<mutex> persisting(persistLock);
+        SnapshotImage image;
+        {
+            ReadGuard reading(stateLock);
+            captureSnapshot(image);
         }
-        
-        ofstream fout(filename, ios::trunc);
-        if (!fout) {
-            cout << RED << "Error: Could not save to file." << RESET << "\n";
-            return;
+        if (!writeSnapshot(image)) {
+            lock_guard<mutex> queue(journalLock);
+            snapshotFailures++;
+            return false;
         }
-        
-        Booking* temp = head;
-        while (temp) {
-            fout << temp->name << ","
-                 << temp->roomNo << ","
-                 << temp->roomType << ","
-                 << temp->checkInDate.toString() << ","
-                 << temp->checkOutDate.toString() << ","
-                 << temp->numDays << ","
-                 << temp->totalAmount << endl;
-            temp = temp->next;
+
+        // Queued records the snapshot holds need never reach the journal
+        unique_lock<shared_mutex> writing(stateLock);
+        journalRecords -= image.journalRecords;
+        if (journalSeq == image.header.journalSeq) {
+            journal.truncate(dataFile("_journal.txt"));
+            journalRecords = 0;
+            lock_guard<mutex> queue(journalLock);
+            journalPending.clear();
+            journalPendingRecords = 0;
+            journalWrittenSeq = journalQueuedSeq;
+            journalFailing = false;
+            journalWritten.notify_all();
         }
-        fout.close();
+        return true;
     }
 
-    void loadFromFile() {
-        string filename = hotelName + "_bookings.txt";
-        for (char& c : filename) {
-            if (c == ' ') c = '_';
-        }
-        
-        ifstream fin(filename);
-        if (!fin) return;
-        
-        string line;
-        while (getline(fin, line)) {
-            if (line.empty()) continue;
-            
-            stringstream ss(line);
-            string name, roomType, checkIn, checkOut;
-            int roomNo, numDays;
-            double amount;
-            
-            getline(ss, name, ',');
-            ss >> roomNo;
-            ss.ignore();
-            getline(ss, roomType, ',');
-            getline(ss, checkIn, ',');
-            getline(ss, checkOut, ',');
-            ss >> numDays;
-            ss.ignore();
-            ss >> amount;
-            
-            if (roomNo >= 1 && roomNo <= TOTAL_ROOMS && !roomOccupied[roomNo]) {
-                Booking* b = new Booking();
-                b->name = name;
-                b->roomNo = roomNo;
-                b->roomType = roomType;
-                b->checkInDate = parseDate(checkIn);
-                b->checkOutDate = parseDate(checkOut);
-                b->numDays = numDays;
-                b->totalAmount = amount;
-                b->next = nullptr;
-                
-                insertBookingNode(b);
-                roomOccupied[roomNo] = true;
-                roomBookingMap[roomNo] = b;
-                nameBookingMap[b->name] = b;
-                bookedRooms++;
-            }
+    // Cancellation and checkout name the stay by room and check-in date and
+    // return false if it is no longer booked (e.g. another desk removed it).
+    // Waiting guests seated in the freed room are added to assigned.
+    bool cancelReservation(int roomNo, const Date& checkIn, vector<Booking>* assigned = nullptr) {
+        WriteGuard writing(*this);
+        Booking* b = findStay(roomNo, checkIn);
+        if (!b) return false;
+        Date from = b->checkInDate;
+        journalRemove(b);
+        unlinkBooking(b);
+        pool.release(b);
+        assignFromWaitingList(roomNo, from, assigned);
+        return true;
+    }
+
+    bool checkOut(int roomNo, const Date& checkIn, vector<Booking>* assigned = nullptr) {
+        WriteGuard writing(*this);
+        Booking* b = findStay(roomNo, checkIn);
+        if (!b) return false;
+        Date from = b->checkInDate;
+        journalRemove(b);
+        unlinkBooking(b);
+        if (Booking* oldest = recentCheckouts.push(b)) {
+            archiveCheckout(oldest);
         }
-        fin.close();
+        assignFromWaitingList(roomNo, from, assigned);
+        return true;
     }
 
-public:
-    HotelSystem(const string& name = "Grand Hotel", int rooms = TOTAL_ROOMS) 
-        : hotelName(name), totalRooms(rooms), bookedRooms(0) {
-        head = nullptr;
-        for (int i = 0; i <= TOTAL_ROOMS; i++) {
-            roomOccupied[i] = false;
+    vector<Booking> getRoomBookings(int roomNo) const {
+        ReadGuard reading(stateLock);
+        vector<Booking> stays;
+        if (!roomExists(roomNo)) return stays;
+        for (auto& entry : roomSchedule[roomNo]) {
+            stays.push_back(Booking::detached(entry.second));
         }
-        loadFromFile();
+        return stays;
     }
 
-    ~HotelSystem() {
-        Booking* temp = head;
-        while (temp) {
-            Booking* nxt = temp->next;
-            delete temp;
-            temp = nxt;
+    vector<Booking> getGuestBookings(const string& name) const {
+        ReadGuard reading(stateLock);
+        vector<Booking> stays;
+        auto it = nameBookingMap.find(normalizeName(name));
+        if (it == nameBookingMap.end()) return stays;
+        for (Booking* b = it->second; b; b = b->guestNext) {
+            stays.push_back(Booking::detached(b));
         }
+        return stays;
     }
 
-    string getHotelName() const {
-        return hotelName;
+    // Bookings of every guest whose name starts with prefix, up to limit names
+    vector<Booking> getPrefixBookings(const string& prefix, int limit) const {
+        ReadGuard reading(stateLock);
+        vector<Booking> stays;
+        for (const string& match : nameTrie.withPrefix(normalizeName(prefix), limit)) {
+            auto it = nameBookingMap.find(match);
+            if (it == nameBookingMap.end()) continue;
+            for (Booking* b = it->second; b; b = b->guestNext) {
+                stays.push_back(Booking::detached(b));
+            }
+        }
+        return stays;
     }
 
-    int getAvailableRooms() const {
-        return totalRooms - bookedRooms;
+    // order: 1 = room number, 2 = customer name, 3 = check-in date. The
+    // indexes are kept ordered on every insert and erase, so this is a
+    // straight in-order walk.
+    vector<Booking> getSortedBookings(int order) const {
+        ReadGuard reading(stateLock);
+        vector<Booking> sorted;
+        sorted.reserve(bookingCount);
+        if (order == 1) {
+            for (int i = 1; i <= maxRoomNo; i++) {
+                for (auto& entry : roomSchedule[i]) {
+                    sorted.push_back(Booking::detached(entry.second));
+                }
+            }
+        } else if (order == 2) {
+            for (const Booking* b : bookingsByName) {
+                sorted.push_back(Booking::detached(b));
+            }
+        } else {
+            for (const Booking* b : bookingsByCheckIn) {
+                sorted.push_back(Booking::detached(b));
+            }
+        }
+        return sorted;
     }
 
-    int getTotalRooms() const {
-        return totalRooms;
+    vector<Booking> getAllBookings() const {
+        ReadGuard reading(stateLock);
+        vector<Booking> all;
+        all.reserve(bookingCount);
+        for (Booking* b = head; b; b = b->next) {
+            all.push_back(Booking::detached(b));
+        }
+        return all;
     }
 
     void showAvailableRooms() {
         clearScreen();
         centerText("========= AVAILABLE ROOMS =========");
-        cout << "\n";
+        ReadGuard reading(stateLock);
+        lock_guard<mutex> cache(freeRoomsLock);
+        refreshFreeRooms();
+        cout << "\n" << CYAN << "Rooms free tonight (" << freeNight.toString() << "):" << RESET << "\n\n";
         
-        vector<int> standard, deluxe, suite;
-        
-        for (int i = 1; i <= TOTAL_ROOMS; i++) {
-            if (!roomOccupied[i]) {
-                if (ROOM_PRICES[i - 1] == 5000) {
-                    standard.push_back(i);
-                } else if (ROOM_PRICES[i - 1] == 7000) {
-                    deluxe.push_back(i);
-                } else if (ROOM_PRICES[i - 1] == 10000) {
-                    suite.push_back(i);
-                }
-            }
+        int available = 0;
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            available += freeRooms[t].count();
         }
-        
-        if (standard.empty() && deluxe.empty() && suite.empty()) {
+        if (available == 0) {
             cout << RED << "No rooms currently available." << RESET << "\n";
         } else {
-            cout << YELLOW << "STANDARD ROOMS (Rs 5,000/night):" << RESET << "\n";
-            if (standard.empty()) {
-                cout << RED << "  No standard rooms available" << RESET << "\n";
-            } else {
-                cout << GREEN << "  Available: " << RESET;
-                for (size_t i = 0; i < standard.size(); i++) {
-                    cout << standard[i];
-                    if (i < standard.size() - 1) cout << ", ";
-                }
-                cout << "\n";
-            }
-            
-            cout << YELLOW << "\nDELUXE ROOMS (Rs 7,000/night):" << RESET << "\n";
-            if (deluxe.empty()) {
-                cout << RED << "  No deluxe rooms available" << RESET << "\n";
-            } else {
-                cout << GREEN << "  Available: " << RESET;
-                for (size_t i = 0; i < deluxe.size(); i++) {
-                    cout << deluxe[i];
-                    if (i < deluxe.size() - 1) cout << ", ";
-                }
-                cout << "\n";
-            }
-            
-            cout << YELLOW << "\nSUITE ROOMS (Rs 10,000/night):" << RESET << "\n";
-            if (suite.empty()) {
-                cout << RED << "  No suite rooms available" << RESET << "\n";
-            } else {
-                cout << GREEN << "  Available: " << RESET;
-                for (size_t i = 0; i < suite.size(); i++) {
-                    cout << suite[i];
-                    if (i < suite.size() - 1) cout << ", ";
+            for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+                string upper = ROOM_TYPES[t].name;
+                transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+                string lower = normalizeName(ROOM_TYPES[t].name);
+
+                cout << YELLOW << (t > 0 ? "\n" : "") << upper << " ROOMS (" << ROOM_TYPES[t].rateLabel << "/night):" << RESET << "\n";
+                if (freeRooms[t].first() == -1) {
+                    cout << RED << "  No " << lower << " rooms available" << RESET << "\n";
+                } else {
+                    cout << GREEN << "  Available: " << RESET;
+                    const char* sep = "";
+                    freeRooms[t].forEach([&](int slot) {
+                        cout << sep << roomsByType[t][slot];
+                        sep = ", ";
+                    });
+                    cout << "\n";
                 }
-                cout << "\n";
             }
         }
         printLine(BLUE);
@@ -528,90 +2762,58 @@ public:
         centerText("========= NEW BOOKING =========");
         cout << "\n";
         
-        Booking* newBooking = new Booking();
-
-        newBooking->name = readNonEmptyString("Enter Customer Name: ");
+        string name = readNonEmptyString("Enter Customer Name: ");
+        Date checkIn, checkOut;
         
         Date today = getCurrentDate();
         
         while (true) {
-            newBooking->checkInDate = readDate("Enter Check-in Date (DD/MM/YYYY): ");
-            if (today <= newBooking->checkInDate) {
+            checkIn = readDate("Enter Check-in Date (DD/MM/YYYY): ");
+            if (today <= checkIn) {
                 break;
             }
             cout << RED << "Check-in date cannot be in the past. Please enter a future date." << RESET << "\n";
         }
 
         while (true) {
-            newBooking->checkOutDate = readDate("Enter Check-out Date (DD/MM/YYYY): ");
-            if (newBooking->checkInDate < newBooking->checkOutDate) {
+            checkOut = readDate("Enter Check-out Date (DD/MM/YYYY): ");
+            if (checkIn < checkOut) {
                 break;
             }
             cout << RED << "Check-out date must be after check-in date. Please try again." << RESET << "\n";
         }
 
-        newBooking->numDays = newBooking->checkInDate.daysBetween(newBooking->checkOutDate);
-        if (newBooking->numDays <= 0) {
-            newBooking->numDays = 1;
-        }
-
         cout << YELLOW << "\n--- Select Room Type ---" << RESET << "\n";
         cout << "1. Standard Room - Rs 5,000 per night\n";
         cout << "2. Deluxe Room - Rs 7,000 per night\n";
         cout << "3. Suite Room - Rs 10,000 per night\n";
         
-        int roomChoice;
-        double selectedPrice;
-        string roomType;
-        
         while (true) {
-            roomChoice = readInt("Enter your choice (1-3): ", 1, 3);
-            
-            if (roomChoice == 1) {
-                selectedPrice = 5000;
-                roomType = "Standard";
-            } else if (roomChoice == 2) {
-                selectedPrice = 7000;
-                roomType = "Deluxe";
-            } else {
-                selectedPrice = 10000;
-                roomType = "Suite";
-            }
+            int roomChoice = readInt("Enter your choice (1-3): ", 1, 3);
+            const RoomTypeInfo& type = ROOM_TYPES[roomChoice - 1];
             
-            int availableRoom = findAvailableRoomByPrice(selectedPrice);
+            Booking confirmed;
+            const Booking* newBooking = &confirmed;
             
-            if (availableRoom != -1) {
-                newBooking->roomNo = availableRoom;
-                newBooking->roomType = roomType;
-                newBooking->totalAmount = selectedPrice * newBooking->numDays;
-                newBooking->next = nullptr;
-
-                insertBookingNode(newBooking);
-                roomOccupied[availableRoom] = true;
-                roomBookingMap[availableRoom] = newBooking;
-                nameBookingMap[newBooking->name] = newBooking;
-                bookedRooms++;
-                
+            if (bookRoom(name, checkIn, checkOut, type, &confirmed)) {
                 printLine(GREEN);
                 cout << GREEN << "✓ Booking confirmed successfully!" << RESET << "\n";
                 printLine(GREEN);
                 cout << "Customer: " << BOLDWHITE << newBooking->name << RESET << "\n";
-                cout << "Room Type: " << YELLOW << roomType << RESET << "\n";
+                cout << "Room Type: " << YELLOW << type.name << RESET << "\n";
                 cout << "Room Number: " << CYAN << newBooking->roomNo << RESET << "\n";
-                cout << "Room Rate: Rs" << fixed << setprecision(2) << selectedPrice << " per night\n";
+                cout << "Room Rate: Rs" << fixed << setprecision(2) << type.price << " per night\n";
                 cout << "Number of Days: " << newBooking->numDays << "\n";
                 cout << "Total Amount: " << GREEN << "Rs" << newBooking->totalAmount << RESET << "\n";
                 cout << "Check-in: " << newBooking->checkInDate.toString() << "\n";
                 cout << "Check-out: " << newBooking->checkOutDate.toString() << "\n";
                 printLine(GREEN);
-                
-                saveToFile();
                 return;
             } else {
-                cout << RED << "\n✗ No " << roomType << " rooms available!" << RESET << "\n";
+                cout << RED << "\n✗ No " << type.name << " rooms available for these dates!" << RESET << "\n";
                 cout << "Would you like to:\n";
                 cout << "1. Choose a different room type\n";
-                cout << "2. Join waiting list for " << roomType << " room\n";
+                cout << "2. Join waiting list for " << type.name << " room\n";
                 cout << "3. Cancel booking\n";
                 
                 int nextChoice = readInt("Enter your choice (1-3): ", 1, 3);
@@ -619,17 +2821,12 @@ public:
                 if (nextChoice == 1) {
                     continue;
                 } else if (nextChoice == 2) {
-                    newBooking->roomNo = 0;
-                    newBooking->roomType = roomType;
-                    newBooking->totalAmount = selectedPrice * newBooking->numDays;
-                    waitingList.push(*newBooking);
-                    cout << YELLOW << "\n✓ You have been added to the waiting list for " << roomType << " rooms." << RESET << "\n";
+                    joinWaitingList(name, checkIn, checkOut, type);
+                    cout << YELLOW << "\n✓ You have been added to the waiting list for " << type.name << " rooms." << RESET << "\n";
                     cout << "You will be notified when a room becomes available.\n";
-                    delete newBooking;
                     return;
                 } else {
                     cout << RED << "\nBooking cancelled." << RESET << "\n";
-                    delete newBooking;
                     return;
                 }
             }
@@ -641,32 +2838,26 @@ public:
         centerText("========= ALL BOOKINGS =========");
         cout << "\n";
         
-        if (!head) {
+        vector<Booking> rows = getAllBookings();
+        if (rows.empty()) {
             cout << RED << "No active bookings found." << RESET << "\n";
             return;
         }
 
-        printLine(BLUE);
-        cout << BOLDWHITE << left << setw(8) << "Room" << setw(20) << "Customer"
-             << setw(15) << "Type" << setw(12) << "Check-in" << setw(12) << "Check-out" 
-             << setw(8) << "Days" << setw(12) << "Amount" << RESET << "\n";
-        printLine(BLUE);
-
-        Booking* temp = head;
-        while (temp) {
-            cout << YELLOW << left << setw(8) << temp->roomNo << RESET
-                 << setw(20) << temp->name
-                 << setw(15) << temp->roomType
-                 << setw(12) << temp->checkInDate.toString() 
-                 << setw(12) << temp->checkOutDate.toString()
-                 << setw(8) << temp->numDays
-                 << GREEN << "Rs" << fixed << setprecision(2) << temp->totalAmount << RESET << "\n";
-            temp = temp->next;
-        }
-        printLine(BLUE);
+        writeBookingTable(rows);
         
-        cout << CYAN << "Occupied Rooms: " << bookedRooms << "/" << totalRooms << RESET << "\n";
-        printLine(BLUE);
+        int occupied = totalRooms - getAvailableRooms();
+        long long poolHits, poolMisses;
+        {
+            ReadGuard reading(stateLock);
+            poolHits = pool.getHits();
+            poolMisses = pool.getMisses();
+        }
+        screen << CYAN << "Active Bookings: " << (int)rows.size()
+               << " | Occupied Tonight: " << occupied << "/" << totalRooms << RESET << "\n";
+        screen << CYAN << "Booking Pool: " << poolHits << " hits / " << poolMisses << " misses" << RESET << "\n";
+        writeLine(BLUE);
+        screen.flush();
     }
 
     void searchBooking() {
@@ -680,50 +2871,35 @@ public:
         int choice = readInt("Enter your choice (1-2): ", 1, 2);
 
         if (choice == 1) {
-            int roomNo = readInt("Enter Room Number (1-" + to_string(TOTAL_ROOMS) + "): ", 1, TOTAL_ROOMS);
+            int roomNo = readInt("Enter Room Number (1-" + to_string(maxRoomNo) + "): ", 1, maxRoomNo);
 
-            if (roomBookingMap.find(roomNo) != roomBookingMap.end()) {
-                Booking* b = roomBookingMap[roomNo];
+            vector<Booking> stays = getRoomBookings(roomNo);
+            if (!stays.empty()) {
                 printLine(GREEN);
                 cout << GREEN << "✓ Booking Found!" << RESET << "\n";
-                printLine(GREEN);
-                cout << "Customer Name: " << BOLDWHITE << b->name << RESET << "\n";
-                cout << "Room Number: " << CYAN << b->roomNo << RESET << "\n";
-                cout << "Room Type: " << YELLOW << b->roomType << RESET << "\n";
-                cout << "Check-in Date: " << b->checkInDate.toString() << "\n";
-                cout << "Check-out Date: " << b->checkOutDate.toString() << "\n";
-                cout << "Number of Days: " << b->numDays << "\n";
-                cout << "Total Amount: " << GREEN << "Rs" << fixed << setprecision(2) << b->totalAmount << RESET << "\n";
-                printLine(GREEN);
+                writeBookingDetailPages(stays);
             } else {
                 cout << RED << "\nNo booking found for room " << roomNo << "." << RESET << "\n";
             }
         } else {
             string cname = readNonEmptyString("Enter Customer Name: ");
             
-            Booking* found = nullptr;
-            for (auto& pair : nameBookingMap) {
-                if (toLowerCase(pair.first) == toLowerCase(cname)) {
-                    found = pair.second;
-                    break;
-                }
-            }
-            
-            if (found) {
+            vector<Booking> stays = getGuestBookings(cname);
+            if (!stays.empty()) {
                 printLine(GREEN);
                 cout << GREEN << "✓ Booking Found!" << RESET << "\n";
-                printLine(GREEN);
-                cout << "Customer Name: " << BOLDWHITE << found->name << RESET << "\n";
-                cout << "Room Number: " << CYAN << found->roomNo << RESET << "\n";
-                cout << "Room Type: " << YELLOW << found->roomType << RESET << "\n";
-                cout << "Check-in Date: " << found->checkInDate.toString() << "\n";
-                cout << "Check-out Date: " << found->checkOutDate.toString() << "\n";
-                cout << "Number of Days: " << found->numDays << "\n";
-                cout << "Total Amount: " << GREEN << "Rs" << fixed << setprecision(2) << found->totalAmount << RESET << "\n";
-                printLine(GREEN);
-            } else {
+                writeBookingDetailPages(stays);
+                return;
+            }
+
+            stays = getPrefixBookings(cname, 10);
+            if (stays.empty()) {
                 cout << RED << "\nNo booking found for customer: " << cname << RESET << "\n";
+                return;
             }
+
+            cout << YELLOW << "\nNo exact match. Customers starting with \"" << cname << "\":" << RESET << "\n";
+            writeBookingDetailPages(stays);
         }
     }
 
@@ -732,70 +2908,19 @@ public:
         centerText("========= SORT BOOKINGS =========");
         cout << "\n";
         
-        if (!head || !head->next) {
+        if (getBookingCount() < 2) {
             cout << RED << "Not enough bookings to sort." << RESET << "\n";
             return;
         }
 
-        vector<Booking*> bookings;
-        Booking* temp = head;
-        while (temp) {
-            bookings.push_back(temp);
-            temp = temp->next;
-        }
-
         cout << MAGENTA << "Sort by:" << RESET << "\n";
         cout << "1. Room Number\n";
         cout << "2. Customer Name\n";
         cout << "3. Check-in Date\n";
         int choice = readInt("Enter your choice (1-3): ", 1, 3);
 
-        if (choice == 1) {
-            for (size_t i = 0; i + 1 < bookings.size(); ++i) {
-                for (size_t j = 0; j + 1 < bookings.size() - i; ++j) {
-                    if (bookings[j]->roomNo > bookings[j + 1]->roomNo) {
-                        swap(bookings[j], bookings[j + 1]);
-                    }
-                }
-            }
-        } else if (choice == 2) {
-            for (size_t i = 0; i + 1 < bookings.size(); ++i) {
-                for (size_t j = 0; j + 1 < bookings.size() - i; ++j) {
-                    if (bookings[j]->name > bookings[j + 1]->name) {
-                        swap(bookings[j], bookings[j + 1]);
-                    }
-                }
-            }
-        } else if (choice == 3) {
-            for (size_t i = 0; i + 1 < bookings.size(); ++i) {
-                for (size_t j = 0; j + 1 < bookings.size() - i; ++j) {
-                    if (bookings[j + 1]->checkInDate < bookings[j]->checkInDate) {
-                        swap(bookings[j], bookings[j + 1]);
-                    }
-                }
-            }
-        }
-
-        printLine(BLUE);
-        cout << BOLDWHITE << left << setw(8) << "Room"
-             << setw(20) << "Customer"
-             << setw(15) << "Type"
-             << setw(12) << "Check-in"
-             << setw(12) << "Check-out"
-             << setw(8) << "Days"
-             << setw(12) << "Amount" << RESET << "\n";
-        printLine(BLUE);
-
-        for (size_t i = 0; i < bookings.size(); ++i) {
-            cout << YELLOW << left << setw(8) << bookings[i]->roomNo << RESET
-                 << setw(20) << bookings[i]->name
-                 << setw(15) << bookings[i]->roomType
-                 << setw(12) << bookings[i]->checkInDate.toString()
-                 << setw(12) << bookings[i]->checkOutDate.toString()
-                 << setw(8) << bookings[i]->numDays
-                 << GREEN << "Rs" << fixed << setprecision(2) << bookings[i]->totalAmount << RESET << "\n";
-        }
-        printLine(BLUE);
+        writeBookingTable(getSortedBookings(choice));
+        screen.flush();
     }
 
     void cancelBooking() {
@@ -803,19 +2928,21 @@ public:
         centerText("========= CANCEL BOOKING =========");
         cout << "\n";
         
-        int roomNo = readInt("Enter Room Number to cancel (1-" + to_string(TOTAL_ROOMS) + "): ", 1, TOTAL_ROOMS);
+        int roomNo = readInt("Enter Room Number to cancel (1-" + to_string(maxRoomNo) + "): ", 1, maxRoomNo);
 
-        if (roomBookingMap.find(roomNo) == roomBookingMap.end()) {
+        Booking stay;
+        const Booking* b = &stay;
+        if (!selectRoomBooking(roomNo, stay)) {
             cout << RED << "\nNo active booking found for room " << roomNo << "." << RESET << "\n";
             return;
         }
 
-        Booking* b = roomBookingMap[roomNo];
         printLine(YELLOW);
         cout << YELLOW << "Booking Details:" << RESET << "\n";
         cout << "Customer: " << BOLDWHITE << b->name << RESET << "\n";
         cout << "Room: " << CYAN << roomNo << RESET << "\n";
         cout << "Room Type: " << YELLOW << b->roomType << RESET << "\n";
+        cout << "Stay: " << b->checkInDate.toString() << " - " << b->checkOutDate.toString() << "\n";
         cout << "Amount: " << GREEN << "Rs" << fixed << setprecision(2) << b->totalAmount << RESET << "\n";
         printLine(YELLOW);
         cout << RED << "Are you sure you want to cancel this booking? (y/n): " << RESET;
@@ -825,14 +2952,13 @@ public:
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         
         if (ch == 'y' || ch == 'Y') {
-            nameBookingMap.erase(b->name);
-            roomBookingMap.erase(roomNo);
-            roomOccupied[roomNo] = false;
-            removeBookingNode(roomNo);
-            bookedRooms--;
-            cout << GREEN << "\n✓ Booking for room " << roomNo << " has been cancelled." << RESET << "\n";
-            saveToFile();
-            assignFromWaitingList();
+            vector<Booking> assigned;
+            if (cancelReservation(roomNo, b->checkInDate, &assigned)) {
+                showAssigned(assigned);
+                cout << GREEN << "\n✓ Booking for room " << roomNo << " has been cancelled." << RESET << "\n";
+            } else {
+                cout << RED << "\nThis booking was already removed at another desk." << RESET << "\n";
+            }
         } else {
             cout << YELLOW << "\nCancellation aborted." << RESET << "\n";
         }
@@ -843,10 +2969,11 @@ public:
         centerText("========= CHECKOUT =========");
         cout << "\n";
         
-        int roomNo = readInt("Enter Room Number for checkout (1-" + to_string(TOTAL_ROOMS) + "): ", 1, TOTAL_ROOMS);
+        int roomNo = readInt("Enter Room Number for checkout (1-" + to_string(maxRoomNo) + "): ", 1, maxRoomNo);
 
-        if (roomBookingMap.find(roomNo) != roomBookingMap.end()) {
-            Booking* b = roomBookingMap[roomNo];
+        Booking stay;
+        const Booking* b = &stay;
+        if (selectRoomBooking(roomNo, stay)) {
             
             printLine(GREEN);
             cout << BOLDWHITE << "Checkout Details" << RESET << "\n";
@@ -868,20 +2995,16 @@ public:
                 return;
             }
             
-            recentCheckouts.push(*b);
-            nameBookingMap.erase(b->name);
-            roomBookingMap.erase(roomNo);
-            roomOccupied[roomNo] = false;
-            removeBookingNode(roomNo);
-            bookedRooms--;
-            
+            vector<Booking> assigned;
+            if (!checkOut(roomNo, b->checkInDate, &assigned)) {
+                cout << RED << "\nThis booking was already removed at another desk." << RESET << "\n";
+                return;
+            }
+            showAssigned(assigned);
             cout << GREEN << "\n✓ Checkout completed successfully for " << b->name << "." << RESET << "\n";
             cout << "Thank you for staying with us!\n";
-            
-            saveToFile();
-            assignFromWaitingList();
         } else {
-            cout << RED << "\nRoom " << roomNo << " is not currently occupied." << RESET << "\n";
+            cout << RED << "\nRoom " << roomNo << " has no active bookings." << RESET << "\n";
         }
     }
 
@@ -890,73 +3013,351 @@ public:
         centerText("========= RECENT CHECKOUTS =========");
         cout << "\n";
         
-        if (recentCheckouts.empty()) {
-            cout << RED << "No recent check-outs." << RESET << "\n";
+        // One page at a time: only the entries on it are copied, under the
+        // read lock, and the lock is dropped while waiting at the prompt
+        vector<Booking> page;
+        long long archived = 0;
+        for (int shown = 0;;) {
+            int total;
+            {
+                ReadGuard reading(stateLock);
+                total = recentCheckouts.size();
+                archived = archivedCheckouts;
+                page.clear();
+                for (int i = shown; i < total && i < shown + CHECKOUT_PAGE_SIZE; i++) {
+                    page.push_back(Booking::detached(recentCheckouts.recent(i)));
+                }
+            }
+
+            if (shown == 0) {
+                if (page.empty()) {
+                    cout << RED << "No recent check-outs." << RESET << "\n";
+                    return;
+                }
+                printLine(YELLOW);
+                cout << BOLDWHITE << "Recent Checkouts (Most Recent First):" << RESET << "\n";
+                printLine(YELLOW);
+            }
+
+            for (const Booking& b : page) {
+                screen << CYAN << ++shown << ". " << RESET << b.name << " | Room: " << YELLOW << b.roomNo << RESET
+                       << " | Type: " << b.roomType
+                       << " | Days: " << b.numDays
+                       << " | Amount: " << GREEN;
+                screen.money(b.totalAmount) << RESET << "\n";
+            }
+            if (page.empty() || shown >= total || !nextPage(shown, total)) break;
+        }
+        screen.flush();
+        printLine(YELLOW);
+        if (archived > 0) {
+            cout << CYAN << archived << " older checkouts archived this session to " << dataFile("_checkouts.txt") << RESET << "\n";
+        }
+    }
+
+    void showWaitingList() {
+        clearScreen();
+        centerText("========= WAITING LIST =========");
+        cout << "\n";
+        ReadGuard reading(stateLock);
+        
+        bool anyWaiting = false;
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            anyWaiting = anyWaiting || !waitingLists[t].empty();
+        }
+        if (!anyWaiting) {
+            cout << RED << "No customers in waiting list." << RESET << "\n";
             return;
         }
 
-        printLine(YELLOW);
-        cout << BOLDWHITE << "Recent Checkouts (Most Recent First):" << RESET << "\n";
-        printLine(YELLOW);
+        printLine(MAGENTA);
+        cout << BOLDWHITE << "Waiting List:" << RESET << "\n";
+        printLine(MAGENTA);
+
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            if (waitingLists[t].empty()) continue;
+            cout << YELLOW << ROOM_TYPES[t].name << " (highest priority first):" << RESET << "\n";
+            int idx = 1;
+            for (const Booking* b : waitingLists[t].ordered()) {
+                cout << CYAN << "  " << idx++ << ". " << RESET << b->name 
+                     << " | Check-in: " << b->checkInDate.toString()
+                     << " | Check-out: " << b->checkOutDate.toString()
+                     << " | Days: " << b->numDays
+                     << " | Tier: " << b->waitTier << "\n";
+            }
+        }
+        printLine(MAGENTA);
+    }
+};
+
+// Suffix array over the normalized hotel names: every suffix of every name,
+// sorted, so the names containing a query are one binary search plus a scan
+// over the matches.
+class HotelNameIndex {
+private:
+    struct Suffix {
+        int hotel;
+        int offset;
+    };
+
+    vector<string> names;      // normalizeName() of each hotel, by index
+    vector<Suffix> suffixes;   // sorted by suffix text
+
+    string_view suffixText(const Suffix& suffix) const {
+        return string_view(names[suffix.hotel]).substr(suffix.offset);
+    }
+
+    // 0 = whole name, 1 = start of the name, 2 = start of a word, 3 = inside a word
+    int matchRank(const Suffix& suffix, size_t queryLength) const {
+        const string& name = names[suffix.hotel];
+        if (suffix.offset == 0) return name.size() == queryLength ? 0 : 1;
+        return name[suffix.offset - 1] == ' ' ? 2 : 3;
+    }
+
+public:
+    // Hotels are numbered in the order they are added
+    void add(const string& hotelName) {
+        int hotel = names.size();
+        names.push_back(normalizeName(hotelName));
+        for (int offset = 0; offset < (int)names[hotel].size(); offset++) {
+            Suffix suffix = {hotel, offset};
+            auto pos = upper_bound(suffixes.begin(), suffixes.end(), suffix,
+                [this](const Suffix& a, const Suffix& b) { return suffixText(a) < suffixText(b); });
+            suffixes.insert(pos, suffix);
+        }
+    }
+
+    // Hotels whose name contains the query (case and spacing ignored), best
+    // match first by matchRank(), then by shorter name, then by index
+    vector<int> find(const string& query) const {
+        vector<int> result;
+        string key = normalizeName(query);
+        if (key.empty()) return result;
+
+        auto it = lower_bound(suffixes.begin(), suffixes.end(), key,
+            [this](const Suffix& a, const string& k) { return suffixText(a) < string_view(k); });
+
+        vector<pair<int, int>> hits;   // (rank, hotel)
+        for (; it != suffixes.end() && suffixText(*it).substr(0, key.size()) == key; ++it) {
+            hits.push_back(make_pair(matchRank(*it, key.size()), it->hotel));
+        }
+        sort(hits.begin(), hits.end(), [this](const pair<int, int>& a, const pair<int, int>& b) {
+            if (a.first != b.first) return a.first < b.first;
+            if (names[a.second].size() != names[b.second].size()) return names[a.second].size() < names[b.second].size();
+            return a.second < b.second;
+        });
+
+        vector<bool> seen(names.size(), false);
+        for (const pair<int, int>& hit : hits) {
+            if (!seen[hit.second]) {
+                seen[hit.second] = true;
+                result.push_back(hit.second);
+            }
+        }
+        return result;
+    }
+};
+
+// Main multi-hotel system
+class MultiHotelSystem {
+private:
+    // A hotel of the chain. Its HotelSystem is read in by the first acquire()
+    // and stays in memory until enforceBudget() writes it out again. Callers
+    // hold the shared_ptr while they use the hotel, which keeps it resident.
+    // While it is not in memory, availability is its free capacity as last
+    // written out, so findAvailability() need not load it.
+    struct HotelSlot {
+        enum State { UNLOADED, LOADING, RESIDENT, EVICTING };
+
+        string name;
+        int rooms;
+        State state;
+        shared_ptr<HotelSystem> system;
+        shared_ptr<const RoomAvailability> availability;   // null while resident
+        size_t memory;        // getMemoryEstimate() when last measured
+        long long lastUsed;   // useClock at the last acquire()
+        string startupLog;    // held back by loadAll() to print in chain order
+
+        HotelSlot(const string& n, int r) : name(n), rooms(r), state(UNLOADED), memory(0), lastUsed(0) {}
+    };
+
+    vector<unique_ptr<HotelSlot>> hotels;
+    HotelNameIndex nameIndex;
+    size_t memoryBudget;
+    PersistOptions persistOptions;
+    long long useClock;
+    // Guards the slots' state, system, memory and lastUsed. Loading and
+    // flushing run without it; other callers wait on slotReady meanwhile.
+    mutex registryLock;
+    condition_variable slotReady;
+
+    void addHotel(const string& name, int rooms) {
+        hotels.emplace_back(new HotelSlot(name, rooms));
+        nameIndex.add(name);
+    }
+
+    // Reads HOTEL_REGISTRY_FILE; rooms sizes the default layout of a hotel
+    // that has no room file yet. Bad lines and repeated names are skipped.
+    void discoverHotels() {
+        ifstream registry(HOTEL_REGISTRY_FILE);
+        string line;
+        int lineNo = 0;
+        while (registry && getline(registry, line)) {
+            lineNo++;
+            string_view rest = trimView(line);
+            if (rest.empty() || rest[0] == '#') continue;
+
+            string name(trimView(nextField(rest)));
+            int rooms = DEFAULT_ROOMS;
+            rest = trimView(rest);
+            if (name.empty() || (!rest.empty() && (!parseNumber(rest, rooms) || rooms <= 0))) {
+                notices() << YELLOW << "Warning: " << HOTEL_REGISTRY_FILE << " line " << lineNo
+                          << " is not \"name[,rooms]\" and was skipped." << RESET << "\n";
+                continue;
+            }
+            bool known = any_of(hotels.begin(), hotels.end(), [&name](const unique_ptr<HotelSlot>& slot) {
+                return normalizeName(slot->name) == normalizeName(name);
+            });
+            if (known) {
+                notices() << YELLOW << "Warning: " << HOTEL_REGISTRY_FILE << " line " << lineNo
+                          << " repeats hotel " << name << " and was skipped." << RESET << "\n";
+                continue;
+            }
+            addHotel(name, rooms);
+        }
+
+        if (hotels.empty()) {
+            addHotel("The Grand Palace", 10);
+            addHotel("OceanView Resort", 8);
+            addHotel("Mountain Retreat", 12);
+            addHotel("CityLights Inn", 10);
+            addHotel("Royal Heritage Hotel", 15);
+        }
+    }
+
+    // The hotel, read in first if it is not in memory. Whichever thread
+    // asks first loads it; others asking meanwhile wait for that load.
+    // With holdLog the load warnings are left in the slot for loadAll().
+    shared_ptr<HotelSystem> acquire(size_t i, bool holdLog = false) {
+        HotelSlot& slot = *hotels[i];
+        shared_ptr<HotelSystem> system;
+        string log;
+        {
+            unique_lock<mutex> lock(registryLock);
+            slotReady.wait(lock, [&slot] {
+                return slot.state == HotelSlot::UNLOADED || slot.state == HotelSlot::RESIDENT;
+            });
+            if (slot.state == HotelSlot::UNLOADED) {
+                slot.state = HotelSlot::LOADING;
+                lock.unlock();
+                system = make_shared<HotelSystem>(slot.name, slot.rooms, persistOptions);
+                log = system->takeStartupLog();
+                size_t memory = system->getMemoryEstimate();
+                lock.lock();
+                slot.system = system;
+                slot.availability.reset();
+                slot.memory = memory;
+                slot.state = HotelSlot::RESIDENT;
+                if (holdLog) slot.startupLog += log;
+                slotReady.notify_all();
+            }
+            system = slot.system;
+            slot.lastUsed = ++useClock;
+        }
+        if (!holdLog && !log.empty()) notices() << log;
+        enforceBudget();
+        return system;
+    }
+
+    // Writes out least recently used hotels until those in memory fit the
+    // budget. Only hotels nobody holds (use_count() == 1) and with nobody
+    // on a waiting list are candidates; the rest may keep the chain over
+    // budget until they are released.
+    void enforceBudget() {
+        vector<pair<HotelSlot*, shared_ptr<HotelSystem>>> victims;
+        {
+            lock_guard<mutex> lock(registryLock);
+            size_t resident = 0;
+            vector<HotelSlot*> idle;
+            for (auto& slot : hotels) {
+                if (slot->state != HotelSlot::RESIDENT) continue;
+                if (slot->system.use_count() == 1) {
+                    slot->memory = slot->system->getMemoryEstimate();
+                    if (!slot->system->hasWaitingGuests()) idle.push_back(slot.get());
+                }
+                resident += slot->memory;
+            }
+            if (resident <= memoryBudget) return;
 
-        stack<Booking> temp = recentCheckouts;
-        int count = 1;
-        while (!temp.empty()) {
-            Booking b = temp.top();
-            temp.pop();
-            cout << CYAN << count++ << ". " << RESET << b.name << " | Room: " << YELLOW << b.roomNo << RESET
-                 << " | Type: " << b.roomType
-                 << " | Days: " << b.numDays
-                 << " | Amount: " << GREEN << "Rs" << fixed << setprecision(2) << b.totalAmount << RESET << "\n";
+            sort(idle.begin(), idle.end(), [](const HotelSlot* a, const HotelSlot* b) {
+                return a->lastUsed < b->lastUsed;
+            });
+            for (HotelSlot* slot : idle) {
+                if (resident <= memoryBudget) break;
+                slot->state = HotelSlot::EVICTING;
+                resident -= slot->memory;
+                victims.emplace_back(slot, move(slot->system));
+            }
         }
-        printLine(YELLOW);
-    }
 
-    void showWaitingList() {
-        clearScreen();
-        centerText("========= WAITING LIST =========");
-        cout << "\n";
-        
-        if (waitingList.empty()) {
-            cout << RED << "No customers in waiting list." << RESET << "\n";
-            return;
+        // Compacting leaves the whole hotel in its snapshot, and the
+        // destructor archives its recent checkouts
+        for (auto& victim : victims) {
+            if (!victim.second->compact()) {
+                notices() << RED << "Error: Could not save " << victim.first->name
+                          << "; its journal keeps every change." << RESET << "\n";
+            }
+            shared_ptr<const RoomAvailability> availability = victim.second->availabilitySnapshot();
+            victim.second.reset();
+            lock_guard<mutex> lock(registryLock);
+            victim.first->availability = availability;
+            victim.first->state = HotelSlot::UNLOADED;
+            slotReady.notify_all();
         }
+    }
 
-        printLine(MAGENTA);
-        cout << BOLDWHITE << "Waiting List:" << RESET << "\n";
-        printLine(MAGENTA);
+    // The hotel if it is in memory, without loading it
+    shared_ptr<HotelSystem> resident(size_t i) {
+        lock_guard<mutex> lock(registryLock);
+        HotelSlot& slot = *hotels[i];
+        return slot.state == HotelSlot::RESIDENT ? slot.system : nullptr;
+    }
 
-        queue<Booking> temp = waitingList;
-        int idx = 1;
-        while (!temp.empty()) {
-            Booking b = temp.front();
-            temp.pop();
-            cout << CYAN << idx++ << ". " << RESET << b.name 
-                 << " | Type: " << YELLOW << b.roomType << RESET
-                 << " | Check-in: " << b.checkInDate.toString()
-                 << " | Days: " << b.numDays << "\n";
+    // Loads every hotel on a pool of up to hardware_concurrency() threads,
+    // so startup takes as long as the largest hotel rather than the sum
+    void loadAll() {
+        unsigned workers = max(1u, min((unsigned)hotels.size(), thread::hardware_concurrency()));
+        atomic<size_t> next(0);
+        vector<thread> pool;
+        for (unsigned w = 0; w < workers; w++) {
+            pool.emplace_back([this, &next] {
+                for (size_t i = next++; i < hotels.size(); i = next++) {
+                    acquire(i, true);
+                }
+            });
+        }
+        for (thread& t : pool) {
+            t.join();
+        }
+        for (auto& slot : hotels) {
+            notices() << slot->startupLog;
+            slot->startupLog.clear();
         }
-        printLine(MAGENTA);
     }
-};
-
-// Main multi-hotel system
-class MultiHotelSystem {
-private:
-    vector<pair<string, HotelSystem*>> hotels;
     
 public:
-    MultiHotelSystem() {
-        hotels.push_back(make_pair("The Grand Palace", new HotelSystem("The Grand Palace", 10)));
-        hotels.push_back(make_pair("OceanView Resort", new HotelSystem("OceanView Resort", 8)));
-        hotels.push_back(make_pair("Mountain Retreat", new HotelSystem("Mountain Retreat", 12)));
-        hotels.push_back(make_pair("CityLights Inn", new HotelSystem("CityLights Inn", 10)));
-        hotels.push_back(make_pair("Royal Heritage Hotel", new HotelSystem("Royal Heritage Hotel", 15)));
-    }
-    
-    ~MultiHotelSystem() {
-        for (auto& hotel : hotels) {
-            delete hotel.second;
+    // With lazyLoad each hotel's files are read on first access instead of
+    // at startup. memoryBudget is in bytes, see HOTEL_REGISTRY_FILE.
+    explicit MultiHotelSystem(bool lazyLoad = false, size_t memoryBudget = DEFAULT_MEMORY_BUDGET_MB << 20,
+                              const PersistOptions& options = PersistOptions())
+        : memoryBudget(memoryBudget), persistOptions(options), useClock(0) {
+        discoverHotels();
+        if (!lazyLoad) {
+            loadAll();
+        } else {
+            for (auto& slot : hotels) {
+                slot->availability = HotelSystem::readSavedAvailability(slot->name);
+            }
         }
     }
     
@@ -966,9 +3367,14 @@ public:
         cout << "\n";
         
         for (size_t i = 0; i < hotels.size(); i++) {
-            cout << CYAN << i + 1 << ". " << BOLDWHITE << hotels[i].first << RESET 
-                 << " (" << GREEN << hotels[i].second->getAvailableRooms() << RESET 
-                 << "/" << hotels[i].second->getTotalRooms() << " rooms available)\n";
+            cout << CYAN << i + 1 << ". " << BOLDWHITE << hotels[i]->name << RESET;
+            shared_ptr<HotelSystem> system = resident(i);
+            if (system) {
+                cout << " (" << GREEN << system->getAvailableRooms() << RESET
+                     << "/" << system->getTotalRooms() << " rooms available)\n";
+            } else {
+                cout << " (" << YELLOW << "not loaded" << RESET << ")\n";
+            }
         }
         cout << CYAN << "0. " << YELLOW << "Search hotel by name" << RESET << "\n\n";
     }
@@ -987,16 +3393,17 @@ public:
                     cout << CYAN << "Enter hotel name to search: " << RESET;
                     getline(cin, searchName);
                     
-                    for (size_t i = 0; i < hotels.size(); i++) {
-                        string hotelLower = hotels[i].first;
-                        string searchLower = searchName;
-                        transform(hotelLower.begin(), hotelLower.end(), hotelLower.begin(), ::tolower);
-                        transform(searchLower.begin(), searchLower.end(), searchLower.begin(), ::tolower);
-                        
-                        if (hotelLower.find(searchLower) != string::npos) {
-                            cout << GREEN << "Found: " << hotels[i].first << RESET << "\n";
-                            return i;
+                    vector<int> found = findHotels(searchName);
+                    if (found.size() == 1) {
+                        cout << GREEN << "Found: " << hotels[found[0]]->name << RESET << "\n";
+                        return found[0];
+                    }
+                    if (found.size() > 1) {
+                        cout << GREEN << "Matching hotels (best first):" << RESET << "\n";
+                        for (size_t i = 0; i < found.size(); i++) {
+                            cout << CYAN << i + 1 << ". " << BOLDWHITE << hotels[found[i]]->name << RESET << "\n";
                         }
+                        return found[readInt("Select hotel (1-" + to_string(found.size()) + "): ", 1, (int)found.size()) - 1];
                     }
                     cout << RED << "No matching hotel found!" << RESET << "\n";
                     displayHotels();
@@ -1018,16 +3425,168 @@ public:
         }
     }
     
-    HotelSystem* getHotel(int index) {
+    // Best-ranked hotel whose name contains the query, or -1
+    int findHotel(const string& query) const {
+        vector<int> found = nameIndex.find(query);
+        return found.empty() ? -1 : found[0];
+    }
+
+    // Writes the queued journal records of every hotel in memory. The input
+    // helpers exit() on end of input while a menu still holds its hotel, so
+    // no destructor would do it; main() registers this with atexit().
+    void flushAll() {
+        for (size_t i = 0; i < hotels.size(); i++) {
+            shared_ptr<HotelSystem> system = resident(i);
+            if (system) system->flush();
+        }
+    }
+
+    // Every hotel whose name contains the query, best match first
+    vector<int> findHotels(const string& query) const {
+        return nameIndex.find(query);
+    }
+    
+    int getHotelCount() const {
+        return hotels.size();
+    }
+
+    struct HotelMatch {
+        int hotel;       // index in the chain
+        int roomNo;      // a room free for the whole stay
+        int idleRooms;   // rooms of the type with no bookings at all
+    };
+
+    // Hotels with a room of the type free for [checkIn, checkOut), best
+    // first: the most rooms of that type still entirely unbooked, then chain
+    // order. Hotels in memory answer from their live RoomAvailability, the
+    // others from the copy in their slot; only a hotel with neither (never
+    // written out with this version) is loaded. Either way the answer takes
+    // time that depends on the nights of the stay rather than on bookings.
+    vector<HotelMatch> findAvailability(const RoomTypeInfo& type, const Date& checkIn, const Date& checkOut) {
+        int typeIndex = findRoomTypeIndex(type.name);
+        vector<HotelMatch> matches;
+        if (typeIndex == -1) return matches;
+
+        for (size_t i = 0; i < hotels.size(); i++) {
+            HotelSlot& slot = *hotels[i];
+            shared_ptr<HotelSystem> hotel;
+            shared_ptr<const RoomAvailability> saved;
+            {
+                unique_lock<mutex> lock(registryLock);
+                slotReady.wait(lock, [&slot] {
+                    return slot.state == HotelSlot::UNLOADED || slot.state == HotelSlot::RESIDENT;
+                });
+                hotel = slot.system;
+                saved = slot.availability;
+            }
+            if (!hotel && !saved) hotel = acquire(i);
+
+            int roomNo, idleRooms;
+            if (hotel) {
+                roomNo = hotel->findRoomFor(type, checkIn, checkOut);
+                idleRooms = hotel->getIdleRooms(typeIndex);
+            } else {
+                roomNo = saved->findRoom(typeIndex, checkIn, checkOut);
+                idleRooms = saved->idleRooms(typeIndex);
+            }
+            if (roomNo != -1) {
+                matches.push_back({(int)i, roomNo, idleRooms});
+            }
+        }
+        stable_sort(matches.begin(), matches.end(), [](const HotelMatch& a, const HotelMatch& b) {
+            return a.idleRooms > b.idleRooms;
+        });
+        return matches;
+    }
+
+    // Books the stay at the best hotel that still has a room for it, trying
+    // the next match if another desk got there first. Returns the hotel
+    // index, or -1.
+    int bookBestMatch(const vector<HotelMatch>& matches, const string& name, const Date& checkIn,
+                      const Date& checkOut, const RoomTypeInfo& type, Booking* confirmed) {
+        for (const HotelMatch& match : matches) {
+            if (acquire(match.hotel)->bookRoom(name, checkIn, checkOut, type, confirmed)) {
+                return match.hotel;
+            }
+        }
+        return -1;
+    }
+
+    void findRoomAnyHotel() {
+        clearScreen();
+        centerText(BG_BLUE + string(BOLDWHITE) + "========= FIND A ROOM IN ANY HOTEL =========" + string(RESET));
+        cout << "\n";
+
+        Date today = getCurrentDate();
+        Date checkIn, checkOut;
+        while (true) {
+            checkIn = readDate("Enter Check-in Date (DD/MM/YYYY): ");
+            if (today <= checkIn) break;
+            cout << RED << "Check-in date cannot be in the past. Please enter a future date." << RESET << "\n";
+        }
+        while (true) {
+            checkOut = readDate("Enter Check-out Date (DD/MM/YYYY): ");
+            if (checkIn < checkOut) break;
+            cout << RED << "Check-out date must be after check-in date. Please try again." << RESET << "\n";
+        }
+
+        cout << YELLOW << "\n--- Select Room Type ---" << RESET << "\n";
+        for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+            cout << t + 1 << ". " << ROOM_TYPES[t].name << " Room - " << ROOM_TYPES[t].rateLabel << " per night\n";
+        }
+        const RoomTypeInfo& type = ROOM_TYPES[readInt("Enter your choice (1-" + to_string(ROOM_TYPE_COUNT) + "): ",
+                                                      1, ROOM_TYPE_COUNT) - 1];
+
+        vector<HotelMatch> matches = findAvailability(type, checkIn, checkOut);
+        if (matches.empty()) {
+            cout << RED << "\n✗ No hotel has a " << type.name << " room free for "
+                 << checkIn.toString() << " - " << checkOut.toString() << "." << RESET << "\n";
+            return;
+        }
+
+        cout << GREEN << "\n" << type.name << " rooms free for " << checkIn.toString() << " - "
+             << checkOut.toString() << ":" << RESET << "\n";
+        for (size_t i = 0; i < matches.size(); i++) {
+            cout << CYAN << i + 1 << ". " << BOLDWHITE << hotels[matches[i].hotel]->name << RESET
+                 << " | Room " << matches[i].roomNo
+                 << " | " << matches[i].idleRooms << " " << type.name << " rooms with no bookings\n";
+        }
+
+        cout << YELLOW << "\nBook at " << hotels[matches[0].hotel]->name << "? (y/n): " << RESET;
+        string answer;
+        if (!getline(cin, answer) || (answer != "y" && answer != "Y")) {
+            cout << CYAN << "No booking made." << RESET << "\n";
+            return;
+        }
+
+        string name = readNonEmptyString("Enter Customer Name: ");
+        Booking confirmed;
+        int booked = bookBestMatch(matches, name, checkIn, checkOut, type, &confirmed);
+        if (booked == -1) {
+            cout << RED << "\n✗ Those rooms were just taken at another desk." << RESET << "\n";
+            return;
+        }
+        cout << GREEN << "\n✓ Booked room " << confirmed.roomNo << " at " << hotels[booked]->name
+             << " for " << confirmed.name << " (Rs" << fixed << setprecision(2) << confirmed.totalAmount
+             << " for " << confirmed.numDays << " days)." << RESET << "\n";
+    }
+    
+    // The hotel, loading it if needed; it stays in memory while the
+    // returned pointer is held
+    shared_ptr<HotelSystem> getHotel(int index) {
         if (index >= 0 && index < (int)hotels.size()) {
-            return hotels[index].second;
+            return acquire(index);
         }
         return nullptr;
     }
+
+    string getHotelName(int index) const {
+        return hotels[index]->name;
+    }
     
     void customerMenu() {
         int hotelIndex = selectHotel();
-        HotelSystem* hotel = getHotel(hotelIndex);
+        shared_ptr<HotelSystem> hotel = getHotel(hotelIndex);
         if (!hotel) return;
         
         int choice;
@@ -1102,7 +3661,7 @@ public:
         cin.get();
         
         int hotelIndex = selectHotel();
-        HotelSystem* hotel = getHotel(hotelIndex);
+        shared_ptr<HotelSystem> hotel = getHotel(hotelIndex);
         if (!hotel) return;
         
         int choice;
@@ -1175,8 +3734,589 @@ public:
     }
 };
 
-int main() {
-    MultiHotelSystem system;
+// Headless command processor: drives HotelSystem directly from a script or
+// stdin, one command per line, with no prompts or screen redraws.
+//
+//   hotel <number|name>
+//   book <standard|deluxe|suite> <DD/MM/YYYY> <DD/MM/YYYY> <customer name>
+//   waitlist <standard|deluxe|suite> <DD/MM/YYYY> <DD/MM/YYYY> <customer name>
+//   leave <customer name>                  (drop their waiting-list requests)
+//   cancel <room> [check-in]
+//   checkout <room> [check-in]
+//   search <room|customer name>
+//   find <standard|deluxe|suite> <DD/MM/YYYY> <DD/MM/YYYY>   (every hotel)
+//   list
+//   export <file>
+//
+// Blank lines and lines starting with '#' are ignored. Results go to stdout;
+// a cancel or checkout that seats waiting guests in the freed room is
+// followed by an "assigned <booking>" line for each. Failures, warnings and
+// errors go to stderr.
+class BatchRunner {
+private:
+    MultiHotelSystem& chain;
+    shared_ptr<HotelSystem> hotel;
+    int lineNo;
+    int errors;
+
+    void fail(const string& message) {
+        cerr << "line " << lineNo << ": " << message << "\n";
+        errors++;
+    }
+
+    static string restOfLine(istringstream& in) {
+        string rest;
+        getline(in, rest);
+        size_t start = rest.find_first_not_of(" \t");
+        size_t end = rest.find_last_not_of(" \t\r");
+        if (start == string::npos) return "";
+        return rest.substr(start, end - start + 1);
+    }
+
+    static const RoomTypeInfo* findRoomType(const string& word) {
+        string key = normalizeName(word);
+        for (int i = 0; i < ROOM_TYPE_COUNT; i++) {
+            if (normalizeName(ROOM_TYPES[i].name) == key) return &ROOM_TYPES[i];
+        }
+        return nullptr;
+    }
+
+    void printBooking(const Booking* b) {
+        ostringstream line;
+        writeBookingFields(line, b);
+        cout << line.str() << "\n";
+    }
+
+    // Waiting guests a cancel or checkout seated in the freed room
+    void printAssigned(const vector<Booking>& assigned) {
+        for (const Booking& b : assigned) {
+            cout << "assigned ";
+            printBooking(&b);
+        }
+    }
+
+    void selectHotel(istringstream& in) {
+        string query = restOfLine(in);
+        int index = -1;
+        if (!query.empty() && all_of(query.begin(), query.end(), ::isdigit)) {
+            index = atoi(query.c_str()) - 1;
+        } else if (!query.empty()) {
+            index = chain.findHotel(query);
+        }
+
+        shared_ptr<HotelSystem> selected = chain.getHotel(index);
+        if (!selected) {
+            fail("unknown hotel '" + query + "'");
+            return;
+        }
+        hotel = selected;
+        cout << "hotel " << hotel->getHotelName() << "\n";
+    }
+
+    void book(istringstream& in, bool waitlistOnly) {
+        string typeWord, inStr, outStr;
+        in >> typeWord >> inStr >> outStr;
+        string name = restOfLine(in);
+
+        const RoomTypeInfo* type = findRoomType(typeWord);
+        Date checkIn = parseDate(inStr);
+        Date checkOut = parseDate(outStr);
+        if (!type) {
+            fail("unknown room type '" + typeWord + "'");
+        } else if (!checkIn.isValid() || !checkOut.isValid() || !(checkIn < checkOut)) {
+            fail("invalid stay " + inStr + " - " + outStr);
+        } else if (name.empty()) {
+            fail("missing customer name");
+        } else if (waitlistOnly) {
+            hotel->joinWaitingList(name, checkIn, checkOut, *type);
+            cout << "waitlisted " << name << "\n";
+        } else {
+            Booking b;
+            if (hotel->bookRoom(name, checkIn, checkOut, *type, &b)) {
+                cout << "booked ";
+                printBooking(&b);
+            } else {
+                fail(string("no ") + type->name + " room free for " + inStr + " - " + outStr);
+            }
+        }
+    }
+
+    // Resolves "<room> [check-in]" to a single booking
+    bool findStay(istringstream& in, Booking& stay) {
+        int roomNo = 0;
+        string inStr;
+        in >> roomNo >> inStr;
+
+        vector<Booking> stays = hotel->getRoomBookings(roomNo);
+        if (!inStr.empty()) {
+            Date checkIn = parseDate(inStr);
+            for (const Booking& b : stays) {
+                if (b.checkInDate == checkIn) {
+                    stay = b;
+                    return true;
+                }
+            }
+            fail("no booking in room " + to_string(roomNo) + " starting " + inStr);
+            return false;
+        }
+        if (stays.size() == 1) {
+            stay = stays[0];
+            return true;
+        }
+
+        if (stays.empty()) {
+            fail("no booking in room " + to_string(roomNo));
+        } else {
+            fail("room " + to_string(roomNo) + " has " + to_string(stays.size()) + " bookings, give the check-in date");
+        }
+        return false;
+    }
+
+    // find <type> <in> <out>: one "available <hotel>,<room>,<idle rooms>"
+    // line per hotel that has a room, best first
+    void findAnyHotel(istringstream& in) {
+        string typeWord, inStr, outStr;
+        in >> typeWord >> inStr >> outStr;
+
+        const RoomTypeInfo* type = findRoomType(typeWord);
+        Date checkIn = parseDate(inStr);
+        Date checkOut = parseDate(outStr);
+        if (!type) {
+            fail("unknown room type '" + typeWord + "'");
+            return;
+        }
+        if (!checkIn.isValid() || !checkOut.isValid() || !(checkIn < checkOut)) {
+            fail("invalid stay " + inStr + " - " + outStr);
+            return;
+        }
+
+        vector<MultiHotelSystem::HotelMatch> matches = chain.findAvailability(*type, checkIn, checkOut);
+        if (matches.empty()) {
+            fail(string("no hotel has a ") + type->name + " room free for " + inStr + " - " + outStr);
+            return;
+        }
+        for (const MultiHotelSystem::HotelMatch& match : matches) {
+            cout << "available " << chain.getHotelName(match.hotel) << ","
+                 << match.roomNo << "," << match.idleRooms << "\n";
+        }
+    }
+
+    void search(istringstream& in) {
+        string query = restOfLine(in);
+        vector<Booking> stays;
+        if (!query.empty() && all_of(query.begin(), query.end(), ::isdigit)) {
+            stays = hotel->getRoomBookings(atoi(query.c_str()));
+        } else {
+            stays = hotel->getGuestBookings(query);
+        }
+
+        if (stays.empty()) {
+            fail("no booking found for '" + query + "'");
+            return;
+        }
+        for (const Booking& b : stays) {
+            printBooking(&b);
+        }
+    }
+
+public:
+    BatchRunner(MultiHotelSystem& system) : chain(system), hotel(system.getHotel(0)), lineNo(0), errors(0) {}
+
+    // Returns the number of commands that failed
+    int run(istream& script) {
+        string line;
+        while (getline(script, line)) {
+            lineNo++;
+            istringstream in(line);
+            string command;
+            if (!(in >> command) || command[0] == '#') continue;
+
+            if (command == "hotel") {
+                selectHotel(in);
+            } else if (command == "book") {
+                book(in, false);
+            } else if (command == "waitlist") {
+                book(in, true);
+            } else if (command == "leave") {
+                string name = restOfLine(in);
+                int removed = hotel->leaveWaitingList(name);
+                if (removed == 0) {
+                    fail("'" + name + "' is not on the waiting list");
+                } else {
+                    cout << "left waiting list " << name << " (" << removed << ")\n";
+                }
+            } else if (command == "cancel") {
+                Booking b;
+                vector<Booking> assigned;
+                if (findStay(in, b) && hotel->cancelReservation(b.roomNo, b.checkInDate, &assigned)) {
+                    cout << "cancelled ";
+                    printBooking(&b);
+                    printAssigned(assigned);
+                }
+            } else if (command == "checkout") {
+                Booking b;
+                vector<Booking> assigned;
+                if (findStay(in, b) && hotel->checkOut(b.roomNo, b.checkInDate, &assigned)) {
+                    cout << "checked out ";
+                    printBooking(&b);
+                    printAssigned(assigned);
+                }
+            } else if (command == "search") {
+                search(in);
+            } else if (command == "find") {
+                findAnyHotel(in);
+            } else if (command == "list") {
+                for (const Booking& b : hotel->getAllBookings()) {
+                    printBooking(&b);
+                }
+            } else if (command == "export") {
+                string file = restOfLine(in);
+                if (file.empty() || !hotel->exportCsv(file)) {
+                    fail("could not export to '" + file + "'");
+                } else {
+                    cout << "exported " << file << "\n";
+                }
+            } else {
+                fail("unknown command '" + command + "'");
+            }
+        }
+        return errors;
+    }
+};
+
+// Microbenchmarks for the HotelSystem hot paths:
+//   hotelmgmt --bench [--csv] [bookings...]
+// Each size fills a scratch hotel with synthetic one-night stays and times
+// booking, room lookup, name search, sorted listings, snapshot save/load and
+// waiting-list reassignment. Results go to stdout as JSON (or CSV), and any
+// warnings or errors to stderr. The number of stays is capped by rooms x
+// days up to the year 2100.
+class Benchmark {
+private:
+    struct Result {
+        string operation;
+        int bookings;
+        long long ops;
+        double totalMs;
+    };
+
+    vector<Result> results;
+    mt19937 rng;
+    volatile long long sink;   // lookup results, so they are not optimised away
+
+    typedef chrono::steady_clock Clock;
+
+    void record(const string& operation, int bookings, long long ops, Clock::time_point start) {
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        results.push_back({operation, bookings, ops, ms});
+    }
+
+    void runSize(int requested) {
+        string hotelName = "Bench Hotel " + to_string(requested);
+        HotelSystem::removeDataFiles(hotelName);
+
+        // Enough rooms for about a year of one-night stays, filled day by
+        // day across every room type
+        int rooms = max(DEFAULT_ROOMS, requested / 365);
+        HotelSystem* hotel = new HotelSystem(hotelName, rooms);
+
+        vector<Date> nights;
+        vector<const RoomTypeInfo*> types;
+        vector<string> names;
+        for (Date night(1, 1, 2025); night.isValid() && (int)nights.size() < requested; night = night.plusDays(1)) {
+            for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+                for (int k = 0; k < hotel->getRoomCount(t) && (int)nights.size() < requested; k++) {
+                    nights.push_back(night);
+                    types.push_back(&ROOM_TYPES[t]);
+                    names.push_back("Guest " + to_string(names.size()));
+                }
+            }
+        }
+        int n = nights.size();
+        long long queries = min(n, 100000);
+
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < n; i++) {
+            hotel->bookRoom(names[i], nights[i], nights[i].plusDays(1), *types[i]);
+        }
+        record("add_booking", n, n, start);
+
+        uniform_int_distribution<int> pick(0, n - 1);
+        long long found = 0;
+        start = Clock::now();
+        for (long long q = 0; q < queries; q++) {
+            int i = pick(rng);
+            found += hotel->findRoomFor(*types[i], nights[i], nights[i].plusDays(1));
+        }
+        record("find_room_by_price", n, queries, start);
+
+        start = Clock::now();
+        for (long long q = 0; q < queries; q++) {
+            found += hotel->getGuestBookings(names[pick(rng)]).size();
+        }
+        record("search_by_name", n, queries, start);
+
+        const char* orders[] = {"sorted_by_room", "sorted_by_name", "sorted_by_checkin"};
+        for (int order = 1; order <= 3; order++) {
+            start = Clock::now();
+            found += hotel->getSortedBookings(order).size();
+            record(orders[order - 1], n, n, start);
+        }
+
+        start = Clock::now();
+        hotel->compact();
+        record("save_snapshot", n, 1, start);
+
+        delete hotel;
+        start = Clock::now();
+        hotel = new HotelSystem(hotelName, rooms);
+        record("load_snapshot", n, 1, start);
+
+        // Waiting guests for the nights about to be freed, plus as many that
+        // cannot be placed, so each cancellation walks a real queue
+        int cancels = min(n, 1000);
+        vector<Booking> all = hotel->getAllBookings();
+        shuffle(all.begin(), all.end(), rng);
+        all.resize(cancels);
+        for (int i = 0; i < cancels; i++) {
+            const RoomTypeInfo& type = ROOM_TYPES[i % ROOM_TYPE_COUNT];
+            hotel->joinWaitingList("Waiting " + to_string(i), nights[0], nights[0].plusDays(1), type);
+        }
+        for (const Booking& b : all) {
+            const RoomTypeInfo* type = &ROOM_TYPES[0];
+            for (int t = 0; t < ROOM_TYPE_COUNT; t++) {
+                if (b.roomType == ROOM_TYPES[t].name) type = &ROOM_TYPES[t];
+            }
+            hotel->joinWaitingList("Waiting " + b.name, b.checkInDate, b.checkOutDate, *type);
+        }
+        start = Clock::now();
+        for (const Booking& b : all) {
+            hotel->cancelReservation(b.roomNo, b.checkInDate);
+        }
+        record("waitlist_reassign", n, cancels, start);
+
+        delete hotel;
+        HotelSystem::removeDataFiles(hotelName);
+        sink = found;
+    }
+
+public:
+    Benchmark() : rng(12345), sink(0) {}
+
+    void run(const vector<int>& sizes, bool csv) {
+        for (int size : sizes) {
+            runSize(size);
+        }
+
+        if (csv) {
+            cout << "operation,bookings,ops,total_ms,ns_per_op\n";
+        } else {
+            cout << "[\n";
+        }
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            double nsPerOp = r.totalMs * 1e6 / max(1LL, r.ops);
+            ostringstream line;
+            line << fixed << setprecision(3);
+            if (csv) {
+                line << r.operation << "," << r.bookings << "," << r.ops << "," << r.totalMs << "," << nsPerOp;
+            } else {
+                line << "  {\"operation\": \"" << r.operation << "\", \"bookings\": " << r.bookings
+                     << ", \"ops\": " << r.ops << ", \"total_ms\": " << r.totalMs
+                     << ", \"ns_per_op\": " << nsPerOp << "}" << (i + 1 < results.size() ? "," : "");
+            }
+            cout << line.str() << "\n";
+        }
+        if (!csv) {
+            cout << "]\n";
+        }
+    }
+};
+
+// Concurrency check of HotelSystem's locking and background persistence:
+//   hotelmgmt [--durable] [--flush-ms n] --stress [threads] [operations]
+// Each thread books, cancels, checks out, searches, lists, joins the
+// waiting list and compacts on one scratch hotel, operations times. Then
+// no room may hold overlapping stays, and the hotel read back from its
+// files must hold the same bookings. Build with -fsanitize=thread to have
+// data races reported too. Prints one summary line; returns false if a
+// check failed.
+class StressTest {
+private:
+    PersistOptions options;
+    atomic<long long> booked;
+    atomic<long long> cancelled;
+    atomic<long long> checkedOut;
+
+    void desk(HotelSystem& hotel, int thread, int operations) {
+        mt19937 rng(thread);
+        string prefix = "Guest " + to_string(thread) + " ";
+        for (int i = 0; i < operations; i++) {
+            Date checkIn = Date(1, 1, 2030).plusDays(rng() % 60);
+            Date checkOut = checkIn.plusDays(1 + rng() % 3);
+            const RoomTypeInfo& type = ROOM_TYPES[rng() % ROOM_TYPE_COUNT];
+            switch (rng() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                if (hotel.bookRoom(prefix + to_string(i), checkIn, checkOut, type)) booked++;
+                break;
+            case 3:
+            case 4:
+                for (const Booking& b : hotel.getGuestBookings(prefix + to_string(rng() % (i + 1)))) {
+                    if (rng() % 2) {
+                        if (hotel.cancelReservation(b.roomNo, b.checkInDate)) cancelled++;
+                    } else if (hotel.checkOut(b.roomNo, b.checkInDate)) {
+                        checkedOut++;
+                    }
+                }
+                break;
+            case 5:
+                hotel.getSortedBookings(1 + rng() % 3);
+                hotel.getAvailableRooms();
+                break;
+            case 6:
+                hotel.joinWaitingList("Waiting " + to_string(thread) + " " + to_string(i), checkIn, checkOut, type);
+                break;
+            default:
+                if (rng() % 50 == 0) hotel.compact();
+                hotel.findRoomFor(type, checkIn, checkOut);
+                break;
+            }
+        }
+    }
+
+    // Stays in a room that overlap the one before, given room order
+    static int countOverlaps(const vector<Booking>& byRoom) {
+        int overlaps = 0;
+        for (size_t i = 1; i < byRoom.size(); i++) {
+            if (byRoom[i].roomNo == byRoom[i - 1].roomNo && byRoom[i].checkInDate < byRoom[i - 1].checkOutDate) {
+                overlaps++;
+            }
+        }
+        return overlaps;
+    }
+
+    static bool sameStays(const vector<Booking>& a, const vector<Booking>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].roomNo != b[i].roomNo || !(a[i].checkInDate == b[i].checkInDate) ||
+                !(a[i].checkOutDate == b[i].checkOutDate) || a[i].name != b[i].name) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    explicit StressTest(const PersistOptions& persist) : options(persist), booked(0), cancelled(0), checkedOut(0) {}
+
+    bool run(int threads, int operations) {
+        const string hotelName = "Stress Hotel";
+        HotelSystem::removeDataFiles(hotelName);
+
+        vector<Booking> live;
+        {
+            HotelSystem hotel(hotelName, 40, options);
+            vector<thread> desks;
+            for (int t = 0; t < threads; t++) {
+                desks.emplace_back(&StressTest::desk, this, ref(hotel), t, operations);
+            }
+            for (thread& t : desks) {
+                t.join();
+            }
+            live = hotel.getSortedBookings(1);
+        }
+        vector<Booking> reloaded = HotelSystem(hotelName, 40).getSortedBookings(1);
+        HotelSystem::removeDataFiles(hotelName);
+
+        int overlaps = countOverlaps(live);
+        bool same = sameStays(live, reloaded);
+        cout << threads << " threads x " << operations << " operations: " << booked << " booked, "
+             << cancelled << " cancelled, " << checkedOut << " checked out; " << live.size() << " live, "
+             << reloaded.size() << " reloaded" << (same ? "" : " (different)") << ", " << overlaps
+             << " overlapping\n";
+        return overlaps == 0 && same;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    // --lazy and --memory-mb <n> may come before any mode: load each hotel
+    // on first use, and keep the hotels in memory under n MiB. --flush-ms,
+    // --flush-batch and --durable set the PersistOptions.
+    bool lazyLoad = false;
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET_MB << 20;
+    PersistOptions persist;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        size_t megabytes;
+        int value;
+        if (arg == "--lazy") {
+            lazyLoad = true;
+        } else if (arg == "--durable") {
+            persist.durable = true;
+        } else if (arg == "--memory-mb" && hasValue && parseNumber(argv[i + 1], megabytes)) {
+            memoryBudget = megabytes << 20;
+            i++;
+        } else if (arg == "--flush-ms" && hasValue && parseNumber(argv[i + 1], value) && value > 0) {
+            persist.flushIntervalMs = value;
+            i++;
+        } else if (arg == "--flush-batch" && hasValue && parseNumber(argv[i + 1], value) && value > 0) {
+            persist.flushBatch = value;
+            i++;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (!args.empty() && args[0] == "--bench") {
+        bool csv = false;
+        vector<int> sizes;
+        for (size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--csv") {
+                csv = true;
+            } else if (atoi(args[i].c_str()) > 0) {
+                sizes.push_back(atoi(args[i].c_str()));
+            }
+        }
+        if (sizes.empty()) {
+            sizes = {1000, 10000, 100000, 1000000};
+        }
+        noticeStream = &cerr;
+        Benchmark bench;
+        bench.run(sizes, csv);
+        return 0;
+    }
+
+    if (!args.empty() && args[0] == "--stress") {
+        int threads = args.size() > 1 ? atoi(args[1].c_str()) : 0;
+        int operations = args.size() > 2 ? atoi(args[2].c_str()) : 0;
+        noticeStream = &cerr;
+        StressTest test(persist);
+        return test.run(threads > 0 ? threads : 8, operations > 0 ? operations : 3000) ? 0 : 1;
+    }
+
+    if (!args.empty() && args[0] == "--batch") {
+        noticeStream = &cerr;
+        MultiHotelSystem system(lazyLoad, memoryBudget, persist);
+        BatchRunner runner(system);
+        if (args.size() > 1 && args[1] != "-") {
+            ifstream script(args[1]);
+            if (!script) {
+                cerr << "Cannot open " << args[1] << "\n";
+                return 1;
+            }
+            return runner.run(script) == 0 ? 0 : 1;
+        }
+        return runner.run(cin) == 0 ? 0 : 1;
+    }
+
+    initTerminal();
+    // static, so the atexit() handler can reach it whichever way we leave
+    static MultiHotelSystem system(lazyLoad, memoryBudget, persist);
+    atexit([] { system.flushAll(); });
     int choice;
     
     do {
@@ -1189,7 +4329,8 @@ int main() {
         cout << BG_GREEN << BOLDWHITE << "         MAIN MENU         " << RESET << "\n\n";
         cout << CYAN << "1. " << RESET << "Customer Login\n";
         cout << CYAN << "2. " << RESET << "Admin Login\n";
-        cout << CYAN << "3. " << RESET << "Exit\n\n";
+        cout << CYAN << "3. " << RESET << "Find a Room in Any Hotel\n";
+        cout << CYAN << "4. " << RESET << "Exit\n\n";
         
         cout << MAGENTA << "Enter your choice: " << RESET;
         if (!(cin >> choice)) {
@@ -1210,6 +4351,11 @@ int main() {
                 system.adminMenu();
                 break;
             case 3:
+                system.findRoomAnyHotel();
+                cout << "\n" << YELLOW << "Press Enter to continue..." << RESET;
+                cin.get();
+                break;
+            case 4:
                 clearScreen();
                 centerText("==========================================================");
                 centerText("          Thank you for using our system!                 ");
@@ -1221,7 +4367,7 @@ int main() {
                 cout << YELLOW << "Press Enter to continue..." << RESET;
                 cin.get();
         }
-    } while (choice != 3);
+    } while (choice != 4);
     
     return 0;
 }
\ No newline at end of file
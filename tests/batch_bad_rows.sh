@@ -0,0 +1,39 @@
+#!/bin/sh
+# Stored rows that would corrupt a room's schedule: a zero-night stay and a
+# second stay with the same check-in as one already in the room. Both must
+# be kept out of the hotel, leaving Ann's stay findable and cancellable.
+#   tests/batch_bad_rows.sh [path/to/hotelmgmt]
+bin=$(cd "$(dirname "${1:-./hotelmgmt}")" && pwd)/$(basename "${1:-./hotelmgmt}")
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cd "$dir" || exit 1
+
+cat > The_Grand_Palace_bookings.txt <<'ROWS'
+Ann,1,Standard,05/01/2027,08/01/2027,3,15000
+Zero,1,Standard,05/01/2027,05/01/2027,0,0
+Dup,1,Standard,05/01/2027,06/01/2027,1,5000
+ROWS
+
+"$bin" --batch - > out.txt 2> err.txt <<'SCRIPT'
+search 1
+list
+cancel 1 05/01/2027
+search 1
+SCRIPT
+
+cat > expected.txt <<'OUT'
+Ann,1,Standard,05/01/2027,08/01/2027,3,15000
+Ann,1,Standard,05/01/2027,08/01/2027,3,15000
+cancelled Ann,1,Standard,05/01/2027,08/01/2027,3,15000
+OUT
+
+status=0
+if ! diff -u expected.txt out.txt; then status=1; fi
+if ! grep -q "line 2: check-out is not after check-in" err.txt; then
+    echo "zero-night row was not rejected"; status=1
+fi
+if [ "$(cat The_Grand_Palace_skipped.txt)" != "Dup,1,Standard,05/01/2027,06/01/2027,1,5000" ]; then
+    echo "duplicate check-in was not moved to the skipped file"; status=1
+fi
+[ $status -eq 0 ] && echo "batch_bad_rows: ok"
+exit $status